@@ -0,0 +1,492 @@
+// A standalone benchmark of the numerical kernels that dominate the run time
+// of BioCro's leaf- and canopy-level modules. It does not require R; see the
+// Makefile in this directory for instructions on building it.
+//
+// Each kernel is called once for each of a fixed set of randomly generated
+// conditions that span the range typically encountered during a growing
+// season (light, temperature, humidity, wind speed, and water stress). The
+// time per call is measured for several repetitions, and the median and
+// minimum are reported. For kernels that use an iterative solver, the mean
+// number of iterations per call and the fraction of calls that did not
+// converge are also reported.
+//
+// Usage:
+//
+//     ./leaf_kernels [--samples n] [--repetitions n] [--min-time seconds]
+//                    [--output file] [--baseline file] [--tolerance fraction]
+//
+// The results are written as a CSV file with one row per kernel, to the
+// standard output or to `--output`. If a `--baseline` file from a previous
+// run is provided, each kernel's median time per call is compared to its
+// baseline value, and the program exits with a status of 1 if any kernel is
+// slower than the baseline by more than `--tolerance` (0.25 by default).
+
+#include <algorithm>  // for std::sort
+#include <chrono>     // for std::chrono::steady_clock
+#include <cmath>      // for std::ceil, std::exp
+#include <cstdio>     // for std::fprintf, std::snprintf
+#include <cstdlib>    // for std::atof, std::atol
+#include <fstream>    // for std::ifstream, std::ofstream
+#include <iostream>   // for std::cout
+#include <map>
+#include <random>     // for std::mt19937_64, std::uniform_real_distribution
+#include <sstream>    // for std::istringstream
+#include <stdexcept>  // for std::runtime_error
+#include <string>
+#include <vector>
+
+#include "../src/module_library/c3photo.h"                     // for c3photoC
+#include "../src/module_library/c4photo.h"                     // for c4photoC
+#include "../src/module_library/FvCB_assim.h"                  // for FvCB_assim
+#include "../src/module_library/ball_berry_gs.h"               // for ball_berry_gs
+#include "../src/module_library/leaf_energy_balance.h"         // for leaf_energy_balance
+#include "../src/module_library/sunML.h"                       // for sunML, Light_profile
+#include "../src/module_library/boundary_layer_conductance.h"  // for leaf_boundary_layer_conductance_nikolov
+#include "../src/module_library/c3_temperature_response.h"     // for c3_temperature_response
+#include "../src/module_library/BioCro.h"                      // for soilML
+#include "../src/module_library/leaf_solver_statistics.h"      // for leaf_solver, get_leaf_solver_statistics, etc
+
+using std::string;
+using std::vector;
+
+namespace
+{
+struct options {
+    size_t samples = 10000;
+    int repetitions = 7;
+    double min_time = 0.05;  // seconds per repetition
+    string output;
+    string baseline;
+    double tolerance = 0.25;
+};
+
+/**
+ * @brief The environmental conditions for one call of each kernel.
+ */
+struct conditions {
+    double ppfd;                  // micromol / m^2 / s
+    double diffuse_fraction;      // dimensionless
+    double cosine_zenith;         // dimensionless
+    double air_temperature;       // degrees C
+    double leaf_temperature;      // degrees C
+    double rh;                    // dimensionless
+    double windspeed;             // m / s
+    double water_stress;          // dimensionless; 1 means no stress
+    double soil_water;            // dimensionless
+    double lai;                   // dimensionless
+    double ci;                    // micromol / mol
+    double stomatal_conductance;  // mol / m^2 / s
+};
+
+/**
+ * @brief Generates a reproducible set of conditions. About a fifth of the
+ * samples are at night, when the photosynthesis solvers behave differently.
+ */
+vector<conditions> generate_conditions(size_t n)
+{
+    std::mt19937_64 rng(20250101);
+    auto uniform = [&rng](double a, double b) {
+        return std::uniform_real_distribution<double>(a, b)(rng);
+    };
+    std::normal_distribution<double> leaf_offset(0.0, 2.0);
+
+    vector<conditions> result(n);
+    for (conditions& c : result) {
+        bool const night = uniform(0, 1) < 0.2;
+        c.ppfd = night ? 0.0 : uniform(10, 2000);
+        c.diffuse_fraction = uniform(0.1, 0.9);
+        c.cosine_zenith = night ? 0.05 : uniform(0.1, 1.0);
+        c.air_temperature = uniform(5, 38);
+        c.leaf_temperature = c.air_temperature + leaf_offset(rng);
+        c.rh = uniform(0.25, 0.95);
+        c.windspeed = uniform(0.5, 6);
+        c.water_stress = uniform(0.2, 1.0);
+        c.soil_water = uniform(0.2, 0.45);
+        c.lai = uniform(0.5, 7);
+        c.ci = uniform(50, 400);
+        c.stomatal_conductance = uniform(0.02, 0.6);
+    }
+    return result;
+}
+
+// Soybean temperature response parameters; see `data/soybean.R`
+c3_temperature_response_parameters const soybean_tr_param{
+    19.02, 37.83e3, 17.57, 43.54e3, 38.05, 79.43e3, 20.30, 36.38e3,
+    0.352, 0.022, -3.4e-4, 18.72, 46.39e3, 0.76, 0.018, -3.7e-4,
+    19.77399, 62.99e3, 182.14e3, 0.588e3, 26.35, 65.33e3};
+
+double constexpr atmospheric_pressure = 101325;  // Pa
+double constexpr gbw_molecular = 1.2;            // mol / m^2 / s
+
+photosynthesis_outputs soybean_leaf(conditions const& c, ci_solver_method solver)
+{
+    return c3photoC(
+        soybean_tr_param, c.ppfd, c.leaf_temperature, c.air_temperature, c.rh,
+        110, 195, 13, 1.28, 0.008, 10.6, 1e-3, 372.59, atmospheric_pressure,
+        210, c.water_stress, 4.5, 5.25, 0.5, gbw_molecular, solver);
+}
+
+photosynthesis_outputs miscanthus_leaf(conditions const& c, ci_solver_method solver)
+{
+    return c4photoC(
+        c.ppfd, c.leaf_temperature, c.air_temperature, c.rh, 39, 0.04, 0.7,
+        0.83, 0.93, 0.8, 0.08, 3, 1e-3, c.water_stress, 400,
+        atmospheric_pressure, 37.5, 3, gbw_molecular, solver);
+}
+
+double saturation_vapor_pressure_approx(double temperature)
+{
+    // Tetens equation, only used to construct realistic inputs (Pa)
+    return 610.78 * std::exp(17.27 * temperature / (temperature + 237.3));
+}
+
+struct kernel_result {
+    string kernel;
+    size_t calls = 0;
+    int repetitions = 0;
+    double median_ns = 0;
+    double min_ns = 0;
+    bool has_iterations = false;
+    double iterations_per_call = 0;
+    bool has_convergence = false;
+    double not_converged_per_call = 0;
+};
+
+// Prevents the compiler from discarding the results of the kernels
+volatile double sink = 0;
+
+/**
+ * @brief Measures the time per call of `call(i)` over all of the samples.
+ * The number of passes through the samples in each repetition is chosen so
+ * that a repetition takes at least `opt.min_time` seconds.
+ */
+template <typename F>
+kernel_result time_kernel(string const& name, size_t n, options const& opt, F call)
+{
+    using clock = std::chrono::steady_clock;
+
+    auto run_passes = [&](size_t passes) {
+        double total = 0;
+        clock::time_point const start = clock::now();
+        for (size_t p = 0; p < passes; ++p) {
+            for (size_t i = 0; i < n; ++i) {
+                total += call(i);
+            }
+        }
+        double const seconds =
+            std::chrono::duration<double>(clock::now() - start).count();
+        sink = sink + total;
+        return seconds;
+    };
+
+    // The first pass also serves as a warm-up
+    double const pass_seconds = run_passes(1);
+    size_t const passes =
+        pass_seconds > 0 ? static_cast<size_t>(std::ceil(opt.min_time / pass_seconds)) : 1;
+
+    vector<double> ns_per_call;
+    for (int r = 0; r < opt.repetitions; ++r) {
+        ns_per_call.push_back(1e9 * run_passes(passes) / (passes * n));
+    }
+    std::sort(ns_per_call.begin(), ns_per_call.end());
+
+    kernel_result result;
+    result.kernel = name;
+    result.calls = passes * n;
+    result.repetitions = opt.repetitions;
+    result.median_ns = ns_per_call[ns_per_call.size() / 2];
+    result.min_ns = ns_per_call.front();
+    return result;
+}
+
+/**
+ * @brief Uses the leaf solver statistics to find the mean number of
+ * iterations per call of a kernel and the fraction of calls that did not
+ * converge.
+ */
+template <typename F>
+void count_solver_iterations(kernel_result& result, leaf_solver solver, size_t n, F call)
+{
+    reset_leaf_solver_statistics();
+    set_leaf_solver_statistics_enabled(true);
+    for (size_t i = 0; i < n; ++i) {
+        sink = sink + call(i);
+    }
+    set_leaf_solver_statistics_enabled(false);
+
+    leaf_solver_statistics const stats =
+        get_leaf_solver_statistics()[static_cast<size_t>(solver)];
+
+    double calls = 0;
+    double iterations = 0;
+    for (size_t b = 0; b < stats.iteration_histogram.size(); ++b) {
+        calls += stats.iteration_histogram[b];
+        iterations += b * static_cast<double>(stats.iteration_histogram[b]);
+    }
+
+    result.has_iterations = true;
+    result.iterations_per_call = calls > 0 ? iterations / calls : 0;
+    result.has_convergence = true;
+    result.not_converged_per_call = calls > 0 ? stats.not_converged / calls : 0;
+}
+
+vector<kernel_result> run_benchmarks(options const& opt)
+{
+    vector<conditions> const samples = generate_conditions(opt.samples);
+    size_t const n = samples.size();
+    vector<kernel_result> results;
+
+    // Leaf photosynthesis, using each method for finding Ci
+    auto c3 = [&](size_t i) { return soybean_leaf(samples[i], ci_solver_method::fixed_point).Assim; };
+    results.push_back(time_kernel("c3photoC", n, opt, c3));
+    count_solver_iterations(results.back(), leaf_solver::c3photoC, n, c3);
+
+    auto c3_brent = [&](size_t i) { return soybean_leaf(samples[i], ci_solver_method::brent).Assim; };
+    results.push_back(time_kernel("c3photoC_brent", n, opt, c3_brent));
+    count_solver_iterations(results.back(), leaf_solver::c3photoC_brent, n, c3_brent);
+
+    auto c4 = [&](size_t i) { return miscanthus_leaf(samples[i], ci_solver_method::fixed_point).Assim; };
+    results.push_back(time_kernel("c4photoC", n, opt, c4));
+    count_solver_iterations(results.back(), leaf_solver::c4photoC, n, c4);
+
+    auto c4_brent = [&](size_t i) { return miscanthus_leaf(samples[i], ci_solver_method::brent).Assim; };
+    results.push_back(time_kernel("c4photoC_brent", n, opt, c4_brent));
+    count_solver_iterations(results.back(), leaf_solver::c4photoC_brent, n, c4_brent);
+
+    // The FvCB model and its temperature response
+    vector<c3_param_at_tleaf> c3_params(n);
+    for (size_t i = 0; i < n; ++i) {
+        c3_params[i] = c3_temperature_response(soybean_tr_param, samples[i].leaf_temperature);
+    }
+
+    results.push_back(time_kernel("c3_temperature_response", n, opt, [&](size_t i) {
+        return c3_temperature_response(soybean_tr_param, samples[i].leaf_temperature).Vcmax_norm;
+    }));
+
+    results.push_back(time_kernel("FvCB_assim", n, opt, [&](size_t i) {
+        c3_param_at_tleaf const& p = c3_params[i];
+        double const J = 195 * p.Jmax_norm * samples[i].ppfd / (samples[i].ppfd + 400);
+        return FvCB_assim(
+                   samples[i].ci, p.Gstar, J, p.Kc, p.Ko, 210, 1.28 * p.Rd_norm,
+                   13 * p.Tp_norm, 110 * p.Vcmax_norm, 0, 4.5, 5.25)
+            .An;
+    }));
+
+    // Stomatal conductance, over a range of assimilation rates
+    results.push_back(time_kernel("ball_berry_gs", n, opt, [&](size_t i) {
+        double const assimilation = samples[i].ppfd * 0.02 - 1.28;
+        return ball_berry_gs(
+                   assimilation, 372.59, samples[i].rh, 0.008, 10.6,
+                   gbw_molecular, samples[i].leaf_temperature,
+                   samples[i].air_temperature)
+            .gsw;
+    }));
+
+    // Leaf energy balance and the boundary layer conductance it depends on
+    vector<int> energy_balance_iterations(n);
+    auto energy_balance = [&](size_t i) {
+        conditions const& c = samples[i];
+        // About half of the incident shortwave energy is PAR, and about half
+        // of it is absorbed
+        energy_balance_outputs const eb = leaf_energy_balance(
+            330, c.ppfd * 0.219, atmospheric_pressure,
+            c.air_temperature, 0.005 + 0.01 * c.windspeed, 0.1, c.rh,
+            c.stomatal_conductance, c.windspeed);
+        energy_balance_iterations[i] = eb.iterations;
+        return eb.TransR;
+    };
+    results.push_back(time_kernel("leaf_energy_balance", n, opt, energy_balance));
+    {
+        double total = 0;
+        for (int it : energy_balance_iterations) {
+            total += it;
+        }
+        results.back().has_iterations = true;
+        results.back().iterations_per_call = total / n;
+    }
+
+    auto nikolov = [&](size_t i) {
+        conditions const& c = samples[i];
+        double const ea = c.rh * saturation_vapor_pressure_approx(c.air_temperature);
+        return leaf_boundary_layer_conductance_nikolov(
+            c.air_temperature, c.leaf_temperature - c.air_temperature, ea,
+            c.stomatal_conductance * 0.025, 0.1, c.windspeed, atmospheric_pressure);
+    };
+    results.push_back(time_kernel("leaf_boundary_layer_conductance_nikolov", n, opt, nikolov));
+    count_solver_iterations(
+        results.back(), leaf_solver::leaf_boundary_layer_conductance_nikolov, n, nikolov);
+
+    // The light profile for a ten-layer canopy
+    Light_profile light_profile;
+    light_profile.resize(10);
+    results.push_back(time_kernel("sunML", n, opt, [&](size_t i) {
+        conditions const& c = samples[i];
+        sunML(
+            c.ppfd * (1 - c.diffuse_fraction) / c.cosine_zenith,
+            c.ppfd * c.diffuse_fraction, 0.81, c.cosine_zenith, 6, 0.7, c.lai,
+            0.42, 0.10, 0.42, 0.05, 0.219, 0.5, 10, light_profile);
+        return light_profile.sunlit_absorbed_ppfd[0];
+    }));
+
+    // The two-layer soil water profile, over a range of soil water contents
+    double soil_depths[] = {0.0, 2.5, 10.0};
+    soilML_str soil_profile;
+    soil_profile.resize(2);
+    results.push_back(time_kernel("soilML", n, opt, [&](size_t i) {
+        conditions const& c = samples[i];
+        double cws[] = {c.soil_water, c.soil_water};
+        soilML(
+            c.ppfd > 0 ? 0.0 : 2.0, 0.05 * c.water_stress, cws, 10.0,
+            soil_depths, 0.32, 0.2, 0.52, -2.6, 6.4e-05, 5.2, 0.32, 0.01, 1.5,
+            2, 2, 0.5, c.lai, 0.68, c.air_temperature, c.ppfd, c.windspeed,
+            c.rh, 0, 0.2, 0.2, 0.44, 0.04, 0.2, 0.01, 1010, 0.219,
+            soil_profile);
+        return soil_profile.cws[0];
+    }));
+
+    return results;
+}
+
+void write_results(std::ostream& out, vector<kernel_result> const& results)
+{
+    out << "kernel,calls,repetitions,median_ns_per_call,min_ns_per_call,"
+           "iterations_per_call,not_converged_per_call\n";
+
+    char line[256];
+    for (kernel_result const& r : results) {
+        std::snprintf(line, sizeof(line), "%s,%lu,%d,%.2f,%.2f,",
+                      r.kernel.c_str(), static_cast<unsigned long>(r.calls),
+                      r.repetitions, r.median_ns, r.min_ns);
+        out << line;
+
+        if (r.has_iterations) {
+            std::snprintf(line, sizeof(line), "%.3f,", r.iterations_per_call);
+            out << line;
+        } else {
+            out << "NA,";
+        }
+
+        if (r.has_convergence) {
+            std::snprintf(line, sizeof(line), "%.5f\n", r.not_converged_per_call);
+            out << line;
+        } else {
+            out << "NA\n";
+        }
+    }
+}
+
+/**
+ * @brief Reads the median time per call for each kernel from a file written
+ * by a previous run.
+ */
+std::map<string, double> read_baseline(string const& file)
+{
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("Unable to read baseline file `" + file + "`");
+    }
+
+    std::map<string, double> baseline;
+    string line;
+    std::getline(in, line);  // header
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        string kernel, calls, repetitions, median;
+        std::getline(fields, kernel, ',');
+        std::getline(fields, calls, ',');
+        std::getline(fields, repetitions, ',');
+        std::getline(fields, median, ',');
+        if (!kernel.empty()) {
+            baseline[kernel] = std::atof(median.c_str());
+        }
+    }
+    return baseline;
+}
+
+/**
+ * @brief Prints a comparison with the baseline and returns the number of
+ * kernels that are slower than their baseline by more than the tolerance.
+ */
+int compare_to_baseline(vector<kernel_result> const& results, options const& opt)
+{
+    std::map<string, double> const baseline = read_baseline(opt.baseline);
+
+    int regressions = 0;
+    std::fprintf(stderr, "\n%-42s %12s %12s %8s\n", "kernel", "baseline_ns", "current_ns", "ratio");
+    for (kernel_result const& r : results) {
+        auto const it = baseline.find(r.kernel);
+        if (it == baseline.end() || it->second <= 0) {
+            std::fprintf(stderr, "%-42s %12s %12.2f %8s\n", r.kernel.c_str(), "NA", r.median_ns, "NA");
+            continue;
+        }
+
+        double const ratio = r.median_ns / it->second;
+        bool const regressed = ratio > 1 + opt.tolerance;
+        regressions += regressed;
+
+        std::fprintf(stderr, "%-42s %12.2f %12.2f %8.3f%s\n", r.kernel.c_str(),
+                     it->second, r.median_ns, ratio, regressed ? "  SLOWER" : "");
+    }
+
+    return regressions;
+}
+
+bool parse_options(int argc, char* argv[], options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        string const arg = argv[i];
+        bool const has_value = i + 1 < argc;
+
+        if (arg == "--samples" && has_value) {
+            opt.samples = static_cast<size_t>(std::atol(argv[++i]));
+        } else if (arg == "--repetitions" && has_value) {
+            opt.repetitions = std::atoi(argv[++i]);
+        } else if (arg == "--min-time" && has_value) {
+            opt.min_time = std::atof(argv[++i]);
+        } else if (arg == "--output" && has_value) {
+            opt.output = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            opt.baseline = argv[++i];
+        } else if (arg == "--tolerance" && has_value) {
+            opt.tolerance = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+
+    return opt.samples > 0 && opt.repetitions > 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::fprintf(stderr,
+                     "Usage: %s [--samples n] [--repetitions n] [--min-time seconds]\n"
+                     "          [--output file] [--baseline file] [--tolerance fraction]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    try {
+        vector<kernel_result> const results = run_benchmarks(opt);
+
+        if (opt.output.empty()) {
+            write_results(std::cout, results);
+        } else {
+            std::ofstream out(opt.output);
+            write_results(out, results);
+        }
+
+        if (!opt.baseline.empty() && compare_to_baseline(results, opt) > 0) {
+            return 1;
+        }
+    } catch (std::exception const& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include <string>
+#include <vector>
+#include <algorithm>                       // for std::max, std::all_of
+#include <cmath>                           // for std::abs
+#include <exception>                       // for std::exception
+#include <Rinternals.h>                    // for Rf_error
+#include "framework/R_helper_functions.h"  // for map_from_list, map_vector_from_list, mc_vector_from_list, list_from_map
+#include "framework/state_map.h"           // for state_map, state_vector_map, string_vector
+#include "framework/module_creator.h"      // for module_creator, mc_vector
+#include "direct_module_evaluator.h"       // for direct_module_evaluator
+#include "R_driver_modules.h"
+
+using std::string;
+
+namespace
+{
+/**
+ *  @brief Stores the results of `precompute_driver_modules()`.
+ */
+struct driver_module_results {
+    std::vector<size_t> module_indices;  // positions in the direct module list
+    state_vector_map outputs;            // one value per driver row
+    state_map max_interpolation_error;   // one value per output quantity
+};
+
+/**
+ *  @brief Identifies direct modules whose inputs are all parameters, drivers,
+ *  or outputs of other such modules, and calculates their outputs at each
+ *  time point of the drivers.
+ *
+ *  The values of these outputs at times between the rows of the drivers can be
+ *  approximated by linear interpolation, in the same way as the drivers. To
+ *  estimate the error of this approximation, the modules are also run at the
+ *  midpoint between each pair of rows, using linearly interpolated driver
+ *  values, and the results are compared to the interpolated outputs.
+ */
+driver_module_results precompute_driver_modules(
+    state_map const& parameters,
+    state_vector_map const& drivers,
+    mc_vector const& direct_mcs)
+{
+    driver_module_results result;
+
+    // Determine which modules only depend on drivers and parameters. Modules
+    // are added in an order where each one only depends on the ones before it.
+    string_set known_quantities;
+    for (auto const& p : parameters) {
+        known_quantities.insert(p.first);
+    }
+    for (auto const& d : drivers) {
+        known_quantities.insert(d.first);
+    }
+
+    std::vector<bool> is_selected(direct_mcs.size(), false);
+    std::vector<module_creator*> selected_mcs;
+    bool found_module = true;
+    while (found_module) {
+        found_module = false;
+        for (size_t i = 0; i < direct_mcs.size(); ++i) {
+            if (is_selected[i]) {
+                continue;
+            }
+
+            string_vector const inputs = direct_mcs[i]->get_inputs();
+            bool const depends_only_on_known = std::all_of(
+                inputs.begin(), inputs.end(), [&](string const& q) {
+                    return known_quantities.count(q) > 0;
+                });
+
+            if (depends_only_on_known) {
+                for (string const& q : direct_mcs[i]->get_outputs()) {
+                    known_quantities.insert(q);
+                }
+                is_selected[i] = true;
+                selected_mcs.push_back(direct_mcs[i]);
+                result.module_indices.push_back(i);
+                found_module = true;
+            }
+        }
+    }
+
+    size_t const nrows = drivers.empty() ? 0 : drivers.begin()->second.size();
+    if (selected_mcs.empty() || nrows == 0) {
+        return result;
+    }
+
+    direct_module_evaluator evaluator{parameters, drivers, selected_mcs};
+    string_vector const& output_names = evaluator.get_output_names();
+
+    for (string const& q : output_names) {
+        result.outputs[q].reserve(nrows);
+        result.max_interpolation_error[q] = 0.0;
+    }
+
+    // Calculate the outputs at each row of the drivers
+    for (size_t i = 0; i < nrows; ++i) {
+        evaluator.set_drivers(drivers, i, 0.0);
+        evaluator.run();
+        for (string const& q : output_names) {
+            result.outputs[q].push_back(evaluator.get(q));
+        }
+    }
+
+    // Estimate the interpolation error at the midpoint between rows
+    for (size_t i = 0; i + 1 < nrows; ++i) {
+        evaluator.set_drivers(drivers, i, 0.5);
+        evaluator.run();
+        for (string const& q : output_names) {
+            std::vector<double> const& values = result.outputs[q];
+            double const interpolated = 0.5 * (values[i] + values[i + 1]);
+            double& max_error = result.max_interpolation_error[q];
+            max_error = std::max(max_error, std::abs(evaluator.get(q) - interpolated));
+        }
+    }
+
+    return result;
+}
+
+}  // namespace
+
+extern "C" {
+/**
+ *  @brief Precalculates the outputs of direct modules that only depend on
+ *  parameters and drivers, so they can be supplied to `R_run_biocro` as
+ *  additional drivers rather than being evaluated by the dynamical system.
+ *
+ *  @param [in] parameters A list of named numeric elements
+ *
+ *  @param [in] drivers A list of named numeric vectors with equal lengths
+ *
+ *  @param [in] direct_mc_vec A list of R external pointers pointing to
+ *              module_creator objects for direct modules
+ *
+ *  @return An R list with three elements: `module_indices`, the (one-based)
+ *          positions of the precalculated modules in `direct_mc_vec`;
+ *          `outputs`, a list of the values of their output quantities at each
+ *          time point; and `max_interpolation_error`, a list containing the
+ *          largest absolute difference between each output calculated at the
+ *          midpoint between two time points and its linearly interpolated
+ *          value.
+ */
+SEXP R_precompute_driver_modules(
+    SEXP parameters,
+    SEXP drivers,
+    SEXP direct_mc_vec)
+{
+    try {
+        state_map p = map_from_list(parameters);
+        state_vector_map d = map_vector_from_list(drivers);
+        mc_vector mcs = mc_vector_from_list(direct_mc_vec);
+
+        driver_module_results const dmr = precompute_driver_modules(p, d, mcs);
+
+        SEXP module_indices = PROTECT(Rf_allocVector(INTSXP, dmr.module_indices.size()));
+        for (size_t i = 0; i < dmr.module_indices.size(); ++i) {
+            INTEGER(module_indices)[i] = static_cast<int>(dmr.module_indices[i]) + 1;
+        }
+
+        SEXP result = PROTECT(Rf_allocVector(VECSXP, 3));
+        SET_VECTOR_ELT(result, 0, module_indices);
+        SET_VECTOR_ELT(result, 1, list_from_map(dmr.outputs));
+        SET_VECTOR_ELT(result, 2, list_from_map(dmr.max_interpolation_error));
+
+        SEXP names = PROTECT(Rf_allocVector(STRSXP, 3));
+        SET_STRING_ELT(names, 0, Rf_mkChar("module_indices"));
+        SET_STRING_ELT(names, 1, Rf_mkChar("outputs"));
+        SET_STRING_ELT(names, 2, Rf_mkChar("max_interpolation_error"));
+        Rf_setAttrib(result, R_NamesSymbol, names);
+
+        UNPROTECT(3);
+        return result;
+    } catch (quantity_access_error const& qae) {
+        Rf_error("%s", (string("Caught quantity access error in R_precompute_driver_modules: ") + qae.what()).c_str());
+    } catch (std::exception const& e) {
+        Rf_error("%s", (string("Caught exception in R_precompute_driver_modules: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_precompute_driver_modules.");
+    }
+}
+}
@@ -0,0 +1,11 @@
+#ifndef R_DRIVER_MODULES_H
+#define R_DRIVER_MODULES_H
+
+#include <Rinternals.h>  // for SEXP
+
+extern "C" SEXP R_precompute_driver_modules(
+    SEXP parameters,
+    SEXP drivers,
+    SEXP direct_mc_vec);
+
+#endif
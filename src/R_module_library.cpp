@@ -47,7 +47,10 @@ extern "C" {
  *  code using the `mc_vector_from_list()` function.
  *
  *  @param [in] module_names The names of the modules for which
- *              `module_creator` objects should be created
+ *              `module_creator` objects should be created. Along with the
+ *              names of modules in the module library, these can be names of
+ *              multilayer modules with a specified number of layers, such as
+ *              `30_layer_c3_canopy`.
  *
  *  @return A vector of "R external pointer" objects
  */
@@ -59,8 +62,13 @@ SEXP R_module_creators(SEXP module_names)
         SEXP mw_ptr_vec = PROTECT(Rf_allocVector(VECSXP, n));
 
         for (size_t i = 0; i < n; ++i) {
-            module_creator* w =
-                module_factory<library>::retrieve(names[i]);
+            // Multilayer modules with a number of layers specified in their
+            // names are not stored in the module factory
+            module_creator* w = library::retrieve_multilayer(names[i]);
+
+            if (!w) {
+                w = module_factory<library>::retrieve(names[i]);
+            }
 
             SEXP mw_ptr =
                 PROTECT(R_MakeExternalPtr(w, R_NilValue, R_NilValue));
@@ -0,0 +1,415 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>                       // for std::any_of, std::all_of, std::find, std::remove
+#include <stdexcept>                       // for std::logic_error
+#include "framework/state_map.h"           // for state_map, state_vector_map, string_vector, string_set
+#include "framework/module_creator.h"      // for module_creator, mc_vector
+#include "framework/validate_dynamical_system.h"  // for validate_dynamical_system_inputs
+#include "direct_module_evaluator.h"       // for direct_module_evaluator
+#include "R_simulation_result.h"           // for quantity_name_matches
+#include "R_module_schedule.h"
+
+using std::string;
+
+namespace
+{
+bool is_recorded(string const& name, string_vector const& record_patterns)
+{
+    return record_patterns.empty() ||
+           std::any_of(record_patterns.begin(), record_patterns.end(),
+                       [&](string const& pattern) {
+                           return quantity_name_matches(pattern, name);
+                       });
+}
+
+bool produces_any(module_creator* mc, string_set const& quantities)
+{
+    string_vector const outputs = mc->get_outputs();
+    return std::any_of(outputs.begin(), outputs.end(), [&](string const& q) {
+        return quantities.count(q) > 0;
+    });
+}
+
+// Marks each unassigned module that produces one of the `wanted` quantities,
+// along with any unassigned modules it depends on, and adds their inputs to
+// `wanted`
+void mark_producers(
+    mc_vector const& direct_mcs,
+    std::vector<bool>& is_assigned,
+    string_set& wanted,
+    mc_vector& marked)
+{
+    bool found_module = true;
+    while (found_module) {
+        found_module = false;
+        for (size_t i = 0; i < direct_mcs.size(); ++i) {
+            if (!is_assigned[i] && produces_any(direct_mcs[i], wanted)) {
+                for (string const& q : direct_mcs[i]->get_inputs()) {
+                    wanted.insert(q);
+                }
+                is_assigned[i] = true;
+                marked.push_back(direct_mcs[i]);
+                found_module = true;
+            }
+        }
+    }
+}
+
+// Removes the modules that only depend on `known_quantities` or the outputs
+// of other such modules from `mcs`, appending them to `selected` in an order
+// where each one only depends on the ones before it
+void select_known_modules(
+    string_set& known_quantities,
+    mc_vector& mcs,
+    mc_vector& selected)
+{
+    bool found_module = true;
+    while (found_module) {
+        found_module = false;
+        for (auto it = mcs.begin(); it != mcs.end();) {
+            string_vector const inputs = (*it)->get_inputs();
+            bool const depends_only_on_known = std::all_of(
+                inputs.begin(), inputs.end(), [&](string const& q) {
+                    return known_quantities.count(q) > 0;
+                });
+
+            if (depends_only_on_known) {
+                for (string const& q : (*it)->get_outputs()) {
+                    known_quantities.insert(q);
+                }
+                selected.push_back(*it);
+                it = mcs.erase(it);
+                found_module = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+// Lists the inputs of `mc` that are not in `known_quantities`
+string_vector missing_inputs(
+    module_creator* mc,
+    string_set const& known_quantities)
+{
+    string_vector missing;
+    for (string const& q : mc->get_inputs()) {
+        if (known_quantities.count(q) == 0) {
+            missing.push_back(q);
+        }
+    }
+    return missing;
+}
+
+string join(string_vector const& strings)
+{
+    string joined;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        joined += (i == 0 ? "" : ", ") + strings[i];
+    }
+    return joined;
+}
+
+}  // namespace
+
+/**
+ *  @brief Checks that the complete sets of direct and differential modules
+ *  could form a valid dynamical system, throwing an exception if they could
+ *  not.
+ *
+ *  @details `schedule_direct_modules()` leaves some direct modules out of the
+ *           dynamical system, so the checks made when the system is created
+ *           would not cover them. This function makes the same checks for all
+ *           of the modules beforehand, so a simulation still fails when, for
+ *           example, a module that would never be run requires a quantity
+ *           that is not defined. The error message names each module and
+ *           quantity involved, followed by the usual validation report.
+ */
+void check_all_modules(
+    state_map const& initial_values,
+    state_map const& parameters,
+    state_vector_map const& drivers,
+    mc_vector const& direct_mcs,
+    mc_vector const& differential_mcs)
+{
+    // Find every source of each quantity
+    std::map<string, string_vector> sources;
+    for (auto const& x : initial_values) {
+        sources[x.first].push_back("the initial values");
+    }
+    for (auto const& x : parameters) {
+        sources[x.first].push_back("the parameters");
+    }
+    for (auto const& x : drivers) {
+        sources[x.first].push_back("the drivers");
+    }
+    for (module_creator* mc : direct_mcs) {
+        for (string const& q : mc->get_outputs()) {
+            sources[q].push_back("the `" + mc->get_name() + "` module");
+        }
+    }
+
+    string problems;
+    string_set defined_quantities;
+    for (auto const& x : sources) {
+        defined_quantities.insert(x.first);
+        if (x.second.size() > 1) {
+            problems += "  `" + x.first + "` is defined more than once, by " +
+                        join(x.second) + "\n";
+        }
+    }
+
+    for (mc_vector const* mcs : {&direct_mcs, &differential_mcs}) {
+        for (module_creator* mc : *mcs) {
+            string_vector const missing = missing_inputs(mc, defined_quantities);
+            if (!missing.empty()) {
+                problems += "  The `" + mc->get_name() +
+                            "` module requires quantities that are not defined: " +
+                            join(missing) + "\n";
+            }
+        }
+    }
+
+    string validation_report;
+    bool const valid = validate_dynamical_system_inputs(
+        validation_report, initial_values, parameters, drivers, direct_mcs,
+        differential_mcs);
+
+    if (!valid || !problems.empty()) {
+        throw std::logic_error(
+            "Thrown by check_all_modules: the supplied inputs cannot form a "
+            "valid dynamical system\n\n" +
+            problems + validation_report);
+    }
+}
+
+/**
+ *  @brief Divides the direct modules of a simulation into four groups using
+ *  their declared inputs and outputs.
+ *
+ *  @details Modules whose outputs are needed, directly or through other direct
+ *           modules, by the differential modules must run whenever the
+ *           derivatives are calculated. Of the remaining modules, those that
+ *           produce a quantity matching one of the `record_patterns` (or any
+ *           quantity, if there are no patterns), along with the modules they
+ *           depend on, only need to run once for each recorded time point.
+ *           All other modules do not affect the result and never need to run.
+ *
+ *           Finally, any modules in the first two groups whose inputs are all
+ *           parameters, or outputs of other such modules, are moved to a
+ *           separate group. Their outputs never change, so they only need to
+ *           run once, before the simulation starts.
+ *
+ *           The parameter modules are ordered so each one only depends on the
+ *           ones before it; the other groups keep their original relative
+ *           order.
+ */
+module_schedule schedule_direct_modules(
+    state_map const& parameters,
+    mc_vector const& direct_mcs,
+    mc_vector const& differential_mcs,
+    string_vector const& record_patterns)
+{
+    std::vector<bool> is_assigned(direct_mcs.size(), false);
+
+    string_set needed;
+    for (module_creator* mc : differential_mcs) {
+        for (string const& q : mc->get_inputs()) {
+            needed.insert(q);
+        }
+    }
+
+    mc_vector derivative_modules;
+    mark_producers(direct_mcs, is_assigned, needed, derivative_modules);
+
+    string_set recorded;
+    for (size_t i = 0; i < direct_mcs.size(); ++i) {
+        if (!is_assigned[i]) {
+            for (string const& q : direct_mcs[i]->get_outputs()) {
+                if (is_recorded(q, record_patterns)) {
+                    recorded.insert(q);
+                }
+            }
+        }
+    }
+
+    mc_vector output_modules;
+    mark_producers(direct_mcs, is_assigned, recorded, output_modules);
+
+    // Restore the original order within each group
+    module_schedule schedule;
+    for (size_t i = 0; i < direct_mcs.size(); ++i) {
+        module_creator* mc = direct_mcs[i];
+        auto contains = [mc](mc_vector const& v) {
+            return std::find(v.begin(), v.end(), mc) != v.end();
+        };
+
+        if (contains(derivative_modules)) {
+            schedule.derivative_modules.push_back(mc);
+        } else if (contains(output_modules)) {
+            schedule.output_modules.push_back(mc);
+        } else {
+            schedule.unused_modules.push_back(mc);
+        }
+    }
+
+    string_set known_quantities;
+    for (auto const& p : parameters) {
+        known_quantities.insert(p.first);
+    }
+
+    mc_vector candidates = schedule.derivative_modules;
+    candidates.insert(candidates.end(), schedule.output_modules.begin(),
+                      schedule.output_modules.end());
+    select_known_modules(known_quantities, candidates, schedule.parameter_modules);
+
+    for (module_creator* mc : schedule.parameter_modules) {
+        for (mc_vector* group : {&schedule.derivative_modules, &schedule.output_modules}) {
+            group->erase(std::remove(group->begin(), group->end(), mc), group->end());
+        }
+    }
+
+    return schedule;
+}
+
+/**
+ *  @brief Runs direct modules that only depend on parameters and returns the
+ *  values of their outputs, which can then be treated as parameters.
+ *
+ *  @param [in] parameter_mcs The modules, ordered so each one only depends on
+ *              the parameters and the ones before it.
+ */
+state_map evaluate_parameter_modules(
+    state_map const& parameters,
+    mc_vector const& parameter_mcs)
+{
+    state_map outputs;
+    if (parameter_mcs.empty()) {
+        return outputs;
+    }
+
+    direct_module_evaluator evaluator{parameters, state_vector_map{}, parameter_mcs};
+    evaluator.run();
+
+    for (string const& q : evaluator.get_output_names()) {
+        outputs[q] = evaluator.get(q);
+    }
+
+    return outputs;
+}
+
+/**
+ *  @brief Adds a column with a constant value to a simulation result for
+ *  each element of `constants`.
+ */
+void add_constant_quantities(
+    state_vector_map& result,
+    state_map const& constants)
+{
+    size_t const nrows = result.empty() ? 0 : result.begin()->second.size();
+
+    for (auto const& c : constants) {
+        result[c.first] = std::vector<double>(nrows, c.second);
+    }
+}
+
+/**
+ *  @brief Runs direct modules once for each time point of a simulation result
+ *  and adds their outputs to the result.
+ *
+ *  @details Each module's inputs are taken from the result if they are present
+ *           there, and from `parameters` otherwise. Since direct modules
+ *           calculate their outputs from the current values of their inputs,
+ *           the added values are the same as they would have been if the
+ *           modules had been part of the simulation.
+ *
+ *           The modules are run in an order where each one only depends on
+ *           the ones before it, so they may be supplied in any order.
+ */
+void evaluate_output_modules(
+    state_vector_map& result,
+    state_map const& parameters,
+    mc_vector const& output_mcs)
+{
+    size_t const nrows = result.empty() ? 0 : result.begin()->second.size();
+    if (output_mcs.empty() || nrows == 0) {
+        return;
+    }
+
+    // Order the modules and find the result columns they use
+    string_set known_quantities;
+    for (auto const& p : parameters) {
+        known_quantities.insert(p.first);
+    }
+
+    state_vector_map columns;
+    for (module_creator* mc : output_mcs) {
+        for (string const& q : mc->get_inputs()) {
+            auto const it = result.find(q);
+            if (it != result.end()) {
+                columns[q] = it->second;
+                known_quantities.insert(q);
+            }
+        }
+    }
+
+    mc_vector unordered_mcs = output_mcs;
+    mc_vector ordered_mcs;
+    select_known_modules(known_quantities, unordered_mcs, ordered_mcs);
+
+    if (!unordered_mcs.empty()) {
+        string problems;
+        for (module_creator* mc : unordered_mcs) {
+            problems += "\n  The `" + mc->get_name() + "` module requires: " +
+                        join(missing_inputs(mc, known_quantities));
+        }
+
+        throw std::logic_error(
+            "Thrown by evaluate_output_modules: the inputs of some direct "
+            "modules could not be found in the simulation result or the "
+            "parameters:" +
+            problems);
+    }
+
+    direct_module_evaluator evaluator{parameters, columns, ordered_mcs};
+    string_vector const& output_names = evaluator.get_output_names();
+
+    for (string const& q : output_names) {
+        result[q].resize(nrows);
+    }
+
+    for (size_t i = 0; i < nrows; ++i) {
+        evaluator.set_drivers(columns, i, 0.0);
+        evaluator.run();
+        for (string const& q : output_names) {
+            result[q][i] = evaluator.get(q);
+        }
+    }
+}
+
+/**
+ *  @brief Describes how the direct modules were divided by
+ *  `schedule_direct_modules()`.
+ */
+string module_schedule_report(module_schedule const& schedule)
+{
+    auto describe = [](string const& heading, mc_vector const& mcs) {
+        string description = heading + " (" + std::to_string(mcs.size()) + "):\n";
+        for (module_creator* mc : mcs) {
+            description += "  " + mc->get_name() + "\n";
+        }
+        return description;
+    };
+
+    return string("\nDirect module schedule:\n\n") +
+           describe("Modules run once because they only depend on parameters",
+                    schedule.parameter_modules) +
+           describe("Modules run for every derivative calculation",
+                    schedule.derivative_modules) +
+           describe("Modules run once per recorded time point",
+                    schedule.output_modules) +
+           describe("Modules that are not run because their outputs are "
+                    "neither used nor recorded",
+                    schedule.unused_modules);
+}
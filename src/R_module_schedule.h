@@ -0,0 +1,47 @@
+#ifndef R_MODULE_SCHEDULE_H
+#define R_MODULE_SCHEDULE_H
+
+#include <string>
+#include "framework/state_map.h"       // for state_map, state_vector_map, string_vector
+#include "framework/module_creator.h"  // for mc_vector
+
+/**
+ *  @brief The direct modules of a simulation, divided according to how their
+ *  outputs are used.
+ */
+struct module_schedule {
+    mc_vector parameter_modules;   // only depend on parameters
+    mc_vector derivative_modules;  // needed to calculate derivatives
+    mc_vector output_modules;      // only needed for recorded quantities
+    mc_vector unused_modules;      // neither needed nor recorded
+};
+
+void check_all_modules(
+    state_map const& initial_values,
+    state_map const& parameters,
+    state_vector_map const& drivers,
+    mc_vector const& direct_mcs,
+    mc_vector const& differential_mcs);
+
+module_schedule schedule_direct_modules(
+    state_map const& parameters,
+    mc_vector const& direct_mcs,
+    mc_vector const& differential_mcs,
+    string_vector const& record_patterns);
+
+state_map evaluate_parameter_modules(
+    state_map const& parameters,
+    mc_vector const& parameter_mcs);
+
+void add_constant_quantities(
+    state_vector_map& result,
+    state_map const& constants);
+
+void evaluate_output_modules(
+    state_vector_map& result,
+    state_map const& parameters,
+    mc_vector const& output_mcs);
+
+std::string module_schedule_report(module_schedule const& schedule);
+
+#endif
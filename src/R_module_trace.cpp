@@ -0,0 +1,67 @@
+#include <string>
+#include <fstream>                         // for std::ofstream
+#include <stdexcept>                       // for std::runtime_error
+#include <exception>                       // for std::exception
+#include <Rinternals.h>                    // for Rf_error
+#include "framework/R_helper_functions.h"  // for list_from_map
+#include "framework/state_map.h"           // for state_map
+#include "module_trace.h"                  // for start_module_trace, stop_module_trace
+#include "R_module_trace.h"
+
+using std::string;
+
+extern "C" {
+
+/**
+ *  @brief Discards any previous trace and starts recording the runs of all
+ *  modules in subsequent simulations.
+ *
+ *  @param [in] events_per_thread A numeric vector with one element giving the
+ *              number of events to keep for each thread.
+ */
+SEXP R_start_module_trace(SEXP events_per_thread)
+{
+    try {
+        start_module_trace(static_cast<size_t>(REAL(events_per_thread)[0]));
+        return R_NilValue;
+    } catch (std::exception const& e) {
+        Rf_error("%s", (string("Caught exception in R_start_module_trace: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_start_module_trace.");
+    }
+}
+
+/**
+ *  @brief Stops recording module runs and writes the recorded events to a
+ *  file in the Chrome Trace Event JSON format.
+ *
+ *  @param [in] file A character vector with one element giving the path of
+ *              the file to write.
+ *
+ *  @return An R list with elements `events`, `dropped_events`, and `threads`.
+ */
+SEXP R_stop_module_trace(SEXP file)
+{
+    try {
+        string const path = CHAR(STRING_ELT(file, 0));
+
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Unable to open `" + path + "` for writing");
+        }
+
+        module_trace_summary const summary = stop_module_trace(out);
+
+        state_map const result{
+            {"events", static_cast<double>(summary.events)},
+            {"dropped_events", static_cast<double>(summary.dropped_events)},
+            {"threads", static_cast<double>(summary.threads)}};
+
+        return list_from_map(result);
+    } catch (std::exception const& e) {
+        Rf_error("%s", (string("Caught exception in R_stop_module_trace: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_stop_module_trace.");
+    }
+}
+}
@@ -0,0 +1,10 @@
+#ifndef R_MODULE_TRACE_H
+#define R_MODULE_TRACE_H
+
+#include <Rinternals.h>  // for SEXP
+
+extern "C" SEXP R_start_module_trace(SEXP events_per_thread);
+
+extern "C" SEXP R_stop_module_trace(SEXP file);
+
+#endif
@@ -0,0 +1,137 @@
+#include <string>
+#include <vector>
+#include <exception>                                 // for std::exception
+#include <Rinternals.h>                              // for Rf_error
+#include "framework/R_helper_functions.h"            // for list_from_map
+#include "framework/state_map.h"                     // for state_map
+#include "module_library/sunML.h"                    // for get_sunML_cache_statistics, reset_sunML_cache_statistics
+#include "module_library/scratch_arena.h"            // for get_scratch_arena_statistics, reset_scratch_arena_statistics
+#include "module_library/heap_allocation_counter.h"  // for get_heap_allocation_count, reset_heap_allocation_count
+#include "module_library/leaf_solver_statistics.h"   // for get_leaf_solver_statistics, reset_leaf_solver_statistics, etc
+#include "R_performance_counters.h"
+
+using std::string;
+
+extern "C" {
+/**
+ *  @brief Returns the current values of counters that describe how often
+ *  cached calculations could be reused and how often memory was allocated,
+ *  optionally resetting them to zero afterwards.
+ *
+ *  The `heap_allocations` counter is only included when heap allocation
+ *  counting was enabled at compile time; see `heap_allocation_counter.h`.
+ *
+ *  The counters are shared by all simulations run in the current R session,
+ *  including those run in parallel by `run_biocro_ensemble`.
+ */
+SEXP R_performance_counters(SEXP reset)
+{
+    try {
+        bool const reset_counters = LOGICAL(VECTOR_ELT(reset, 0))[0];
+
+        sunML_cache_statistics const sunML_stats = get_sunML_cache_statistics();
+
+        scratch_arena_statistics const arena_stats = get_scratch_arena_statistics();
+
+        state_map counters{
+            {"sunML_cache_hits", sunML_stats.hits},
+            {"sunML_cache_misses", sunML_stats.misses},
+            {"scratch_arena_heap_allocations", arena_stats.heap_allocations}};
+
+        if (heap_allocation_counting_enabled()) {
+            counters["heap_allocations"] = get_heap_allocation_count();
+        }
+
+        if (reset_counters) {
+            reset_sunML_cache_statistics();
+            reset_scratch_arena_statistics();
+            reset_heap_allocation_count();
+        }
+
+        return list_from_map(counters);
+    } catch (std::exception const& e) {
+        Rf_error("%s", (string("Caught exception in R_performance_counters: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_performance_counters.");
+    }
+}
+
+/**
+ *  @brief Returns the iteration histograms recorded for the iterative
+ *  leaf-level solvers, optionally enabling or disabling recording and
+ *  resetting the histograms afterwards.
+ *
+ *  @param [in] enable An empty logical vector to leave recording unchanged,
+ *              or a logical vector with one element to enable or disable it.
+ *
+ *  @param [in] reset A list with one logical element indicating whether the
+ *              histograms should be cleared after they are retrieved.
+ *
+ *  @return An R list with one element per solver, each of which is a list
+ *          with elements `calls`, `not_converged`, and `iteration_histogram`.
+ *          The histogram is a named numeric vector whose element `"i"` is the
+ *          number of calls that required `i` iterations; its last element
+ *          counts all calls that required at least that many.
+ */
+SEXP R_leaf_solver_statistics(SEXP enable, SEXP reset)
+{
+    try {
+        bool const reset_histograms = LOGICAL(VECTOR_ELT(reset, 0))[0];
+
+        std::vector<leaf_solver_statistics> const stats = get_leaf_solver_statistics();
+
+        SEXP result = PROTECT(Rf_allocVector(VECSXP, stats.size()));
+        SEXP result_names = PROTECT(Rf_allocVector(STRSXP, stats.size()));
+
+        for (size_t s = 0; s < stats.size(); ++s) {
+            std::vector<unsigned long> const& histogram = stats[s].iteration_histogram;
+            size_t const nbins = histogram.size();
+
+            double calls = 0;
+            SEXP iteration_histogram = PROTECT(Rf_allocVector(REALSXP, nbins));
+            SEXP bin_names = PROTECT(Rf_allocVector(STRSXP, nbins));
+            for (size_t b = 0; b < nbins; ++b) {
+                REAL(iteration_histogram)[b] = histogram[b];
+                calls += histogram[b];
+
+                string const bin_name = std::to_string(b) + (b + 1 == nbins ? "+" : "");
+                SET_STRING_ELT(bin_names, b, Rf_mkChar(bin_name.c_str()));
+            }
+            Rf_setAttrib(iteration_histogram, R_NamesSymbol, bin_names);
+
+            SEXP solver_stats = PROTECT(Rf_allocVector(VECSXP, 3));
+            SET_VECTOR_ELT(solver_stats, 0, Rf_ScalarReal(calls));
+            SET_VECTOR_ELT(solver_stats, 1, Rf_ScalarReal(stats[s].not_converged));
+            SET_VECTOR_ELT(solver_stats, 2, iteration_histogram);
+
+            SEXP solver_names = PROTECT(Rf_allocVector(STRSXP, 3));
+            SET_STRING_ELT(solver_names, 0, Rf_mkChar("calls"));
+            SET_STRING_ELT(solver_names, 1, Rf_mkChar("not_converged"));
+            SET_STRING_ELT(solver_names, 2, Rf_mkChar("iteration_histogram"));
+            Rf_setAttrib(solver_stats, R_NamesSymbol, solver_names);
+
+            SET_VECTOR_ELT(result, s, solver_stats);
+            SET_STRING_ELT(result_names, s, Rf_mkChar(stats[s].name.c_str()));
+
+            UNPROTECT(4);
+        }
+
+        Rf_setAttrib(result, R_NamesSymbol, result_names);
+
+        if (Rf_length(enable) > 0) {
+            set_leaf_solver_statistics_enabled(LOGICAL(enable)[0]);
+        }
+
+        if (reset_histograms) {
+            reset_leaf_solver_statistics();
+        }
+
+        UNPROTECT(2);
+        return result;
+    } catch (std::exception const& e) {
+        Rf_error("%s", (string("Caught exception in R_leaf_solver_statistics: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_leaf_solver_statistics.");
+    }
+}
+}
@@ -0,0 +1,10 @@
+#ifndef R_PERFORMANCE_COUNTERS_H
+#define R_PERFORMANCE_COUNTERS_H
+
+#include <Rinternals.h>  // for SEXP
+
+extern "C" SEXP R_performance_counters(SEXP reset);
+
+extern "C" SEXP R_leaf_solver_statistics(SEXP enable, SEXP reset);
+
+#endif
@@ -1,14 +1,179 @@
 #include <string>
+#include <vector>
+#include <memory>                          // for std::unique_ptr
+#include <cstdio>                          // for std::snprintf
 #include <exception>                       // for std::exception
 #include <Rinternals.h>                    // for Rf_error and Rprintf
-#include "framework/R_helper_functions.h"  // for map_from_list, map_vector_from_list, mc_vector_from_list, list_from_map
+#include "framework/R_helper_functions.h"  // for map_from_list, map_vector_from_list, mc_vector_from_list, make_vector, list_from_map
 #include "framework/state_map.h"           // for state_map, state_vector_map, string_vector
 #include "framework/module_creator.h"      // for mc_vector
 #include "framework/biocro_simulation.h"
+#include "R_simulation_result.h"           // for select_quantities, data_frame_from_result
+#include "R_module_schedule.h"             // for check_all_modules, schedule_direct_modules, evaluate_parameter_modules, etc
+#include "incremental_module.h"            // for incremental_module_creator
+#include "timed_module.h"                  // for timed_module_creator
+#include "instruction_counter.h"           // for instruction_counter
+#include "ode_solver_statistics.h"         // for ode_solver_monitor, monitored_module_creator
+#include "module_trace.h"                  // for module_trace_enabled, trace_modules, record_trace_event
 #include "R_run_biocro.h"
 
 using std::string;
 
+namespace
+{
+/**
+ *  @brief Creates an R list with two elements, `runs` and `skips`, each of
+ *  which is a list with one element per module giving the number of times it
+ *  was run or skipped.
+ */
+SEXP run_counts_list(
+    std::vector<std::unique_ptr<incremental_module_creator>> const& mcs)
+{
+    state_map runs;
+    state_map skips;
+    for (auto const& mc : mcs) {
+        runs[mc->get_name()] = mc->get_counts().runs;
+        skips[mc->get_name()] = mc->get_counts().skips;
+    }
+
+    SEXP result = PROTECT(Rf_allocVector(VECSXP, 2));
+    SET_VECTOR_ELT(result, 0, list_from_map(runs));
+    SET_VECTOR_ELT(result, 1, list_from_map(skips));
+
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 2));
+    SET_STRING_ELT(names, 0, Rf_mkChar("runs"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("skips"));
+    Rf_setAttrib(result, R_NamesSymbol, names);
+
+    UNPROTECT(2);
+    return result;
+}
+
+/**
+ *  @brief Creates an R list with elements `calls`, `total_time`, and
+ *  `max_time`, along with `instructions` if the instruction counter was
+ *  available, each of which is a list with one element per module.
+ */
+SEXP timing_list(
+    std::vector<std::unique_ptr<timed_module_creator>> const& mcs,
+    bool include_instructions)
+{
+    state_map calls;
+    state_map total_time;
+    state_map max_time;
+    state_map instructions;
+    for (auto const& mc : mcs) {
+        module_timing const& t = mc->get_timing();
+        calls[mc->get_name()] = t.calls;
+        total_time[mc->get_name()] = t.total_seconds;
+        max_time[mc->get_name()] = t.max_seconds;
+        instructions[mc->get_name()] = static_cast<double>(t.instructions);
+    }
+
+    int const n = include_instructions ? 4 : 3;
+
+    SEXP result = PROTECT(Rf_allocVector(VECSXP, n));
+    SET_VECTOR_ELT(result, 0, list_from_map(calls));
+    SET_VECTOR_ELT(result, 1, list_from_map(total_time));
+    SET_VECTOR_ELT(result, 2, list_from_map(max_time));
+
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names, 0, Rf_mkChar("calls"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("total_time"));
+    SET_STRING_ELT(names, 2, Rf_mkChar("max_time"));
+
+    if (include_instructions) {
+        SET_VECTOR_ELT(result, 3, list_from_map(instructions));
+        SET_STRING_ELT(names, 3, Rf_mkChar("instructions"));
+    }
+
+    Rf_setAttrib(result, R_NamesSymbol, names);
+
+    UNPROTECT(2);
+    return result;
+}
+
+/**
+ *  @brief Describes the statistics collected by a set of
+ *  `timed_module_creator` objects as a table with one row per module.
+ */
+string timing_report(
+    std::vector<std::unique_ptr<timed_module_creator>> const& mcs,
+    bool include_instructions)
+{
+    double total = 0.0;
+    for (auto const& mc : mcs) {
+        total += mc->get_timing().total_seconds;
+    }
+
+    string report = "\nModule timing (times in microseconds):\n\n";
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "  %12s %12s %8s %12s %12s  %s\n",
+                  "calls", "total", "percent", "mean", "max",
+                  include_instructions ? "instructions per call  module" : "module");
+    report += line;
+
+    for (auto const& mc : mcs) {
+        module_timing const& t = mc->get_timing();
+        double const mean = t.calls > 0 ? t.total_seconds / t.calls : 0.0;
+
+        std::snprintf(line, sizeof(line), "  %12lu %12.0f %8.2f %12.3f %12.3f  ",
+                      t.calls, 1e6 * t.total_seconds,
+                      total > 0.0 ? 100.0 * t.total_seconds / total : 0.0,
+                      1e6 * mean, 1e6 * t.max_seconds);
+        report += line;
+
+        if (include_instructions) {
+            std::snprintf(line, sizeof(line), "%21.0f  ",
+                          t.calls > 0 ? static_cast<double>(t.instructions) / t.calls : 0.0);
+            report += line;
+        }
+
+        report += mc->get_name() + "\n";
+    }
+
+    return report;
+}
+
+/**
+ *  @brief Creates an R list describing the work done by an ODE solver.
+ */
+SEXP ode_solver_statistics_list(ode_solver_statistics const& stats)
+{
+    double const na = NA_REAL;
+
+    state_map const scalars = {
+        {"derivative_evaluations", static_cast<double>(stats.derivative_evaluations)},
+        {"accepted_steps", stats.steps_available ? stats.accepted_steps : na},
+        {"rejected_steps", stats.steps_available ? stats.rejected_steps : na},
+        {"max_attempts_per_output_interval",
+         stats.steps_available ? stats.max_attempts_per_output_interval : na},
+        {"min_step_size", stats.steps_available ? stats.min_step_size : na},
+        {"median_step_size", stats.steps_available ? stats.median_step_size : na},
+        {"max_step_size", stats.steps_available ? stats.max_step_size : na}};
+
+    SEXP interval_time =
+        PROTECT(Rf_allocVector(REALSXP, stats.output_interval_seconds.size()));
+    for (size_t i = 0; i < stats.output_interval_seconds.size(); ++i) {
+        REAL(interval_time)[i] = stats.output_interval_seconds[i];
+    }
+
+    SEXP result = PROTECT(Rf_allocVector(VECSXP, 2));
+    SET_VECTOR_ELT(result, 0, list_from_map(scalars));
+    SET_VECTOR_ELT(result, 1, interval_time);
+
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 2));
+    SET_STRING_ELT(names, 0, Rf_mkChar("counts"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("output_interval_time"));
+    Rf_setAttrib(result, R_NamesSymbol, names);
+
+    UNPROTECT(3);
+    return result;
+}
+
+}  // namespace
+
 extern "C" {
 
 SEXP R_run_biocro(
@@ -22,7 +187,11 @@ SEXP R_run_biocro(
     SEXP solver_adaptive_rel_error_tol,
     SEXP solver_adaptive_abs_error_tol,
     SEXP solver_adaptive_max_steps,
-    SEXP verbose)
+    SEXP quantities_to_record,
+    SEXP verbose,
+    SEXP skip_unchanged_modules,
+    SEXP time_modules,
+    SEXP solver_statistics)
 {
     try {
         state_map iv = map_from_list(initial_values);
@@ -42,18 +211,115 @@ SEXP R_run_biocro(
         double adaptive_rel_error_tol = REAL(solver_adaptive_rel_error_tol)[0];
         double adaptive_abs_error_tol = REAL(solver_adaptive_abs_error_tol)[0];
         int adaptive_max_steps = (int)REAL(solver_adaptive_max_steps)[0];
+        string_vector record_patterns = make_vector(quantities_to_record);
+        bool skip_unchanged = LOGICAL(skip_unchanged_modules)[0];
+        bool record_timing = LOGICAL(time_modules)[0];
+        bool record_solver_statistics = LOGICAL(solver_statistics)[0];
+
+        // Some of the direct modules may be left out of the dynamical system
+        // below, so check all of them here
+        check_all_modules(iv, p, d, direct_mcs, differential_mcs);
+
+        // Only the direct modules that are needed to calculate derivatives
+        // are included in the dynamical system; modules that only depend on
+        // parameters are run once beforehand and their outputs are treated as
+        // parameters, while modules that only produce recorded quantities are
+        // run afterwards, once per time point
+        module_schedule schedule =
+            schedule_direct_modules(p, direct_mcs, differential_mcs, record_patterns);
 
-        biocro_simulation gro(iv, p, d, direct_mcs, differential_mcs,
+        state_map const folded = evaluate_parameter_modules(p, schedule.parameter_modules);
+        p.insert(folded.begin(), folded.end());
+
+        // If requested, wrap the remaining direct modules so they are skipped
+        // whenever their inputs are unchanged since their previous run
+        mc_vector system_direct_mcs = schedule.derivative_modules;
+        std::vector<std::unique_ptr<incremental_module_creator>> incremental_mcs;
+        if (skip_unchanged) {
+            for (module_creator*& mc : system_direct_mcs) {
+                incremental_mcs.emplace_back(new incremental_module_creator(mc));
+                mc = incremental_mcs.back().get();
+            }
+        }
+
+        // If requested, wrap all of the modules in the dynamical system so
+        // the time spent in each of them is recorded
+        mc_vector system_differential_mcs = differential_mcs;
+        instruction_counter instructions;
+        std::vector<std::unique_ptr<timed_module_creator>> timed_mcs;
+        if (record_timing) {
+            for (mc_vector* mcs : {&system_direct_mcs, &system_differential_mcs}) {
+                for (module_creator*& mc : *mcs) {
+                    timed_mcs.emplace_back(new timed_module_creator(mc, instructions));
+                    mc = timed_mcs.back().get();
+                }
+            }
+        }
+
+        // If a trace is being recorded, wrap all of the modules in the
+        // dynamical system so each of their runs is added to it
+        std::vector<std::unique_ptr<traced_module_creator>> traced_mcs;
+        if (module_trace_enabled()) {
+            trace_modules(system_direct_mcs, system_differential_mcs, traced_mcs);
+        }
+
+        // If requested, wrap one differential module so the times at which
+        // the ODE solver calculates derivatives are recorded
+        ode_solver_monitor monitor;
+        std::unique_ptr<monitored_module_creator> monitored_mc;
+        if (record_solver_statistics && !system_differential_mcs.empty()) {
+            monitored_mc.reset(
+                new monitored_module_creator(system_differential_mcs[0], monitor));
+            system_differential_mcs[0] = monitored_mc.get();
+        }
+
+        biocro_simulation gro(iv, p, d, system_direct_mcs, system_differential_mcs,
                               solver_type_string, output_step_size,
                               adaptive_rel_error_tol, adaptive_abs_error_tol,
                               adaptive_max_steps);
+        record_trace_event("simulation", "simulation", 'B');
         state_vector_map result = gro.run_simulation();
+        record_trace_event("simulation", "simulation", 'E');
+
+        ode_solver_statistics solver_stats;
+        if (record_solver_statistics) {
+            solver_stats = monitor.summarize(solver_type_string, result.at("time"));
+        }
+
+        evaluate_output_modules(result, p, schedule.output_modules);
+        add_constant_quantities(result, folded);
+        select_quantities(result, record_patterns);
 
         if (loquacious) {
             Rprintf("%s", gro.generate_report().c_str());
+            Rprintf("%s", module_schedule_report(schedule).c_str());
+            if (record_timing) {
+                Rprintf("%s", timing_report(timed_mcs, instructions.available()).c_str());
+            }
+            if (record_solver_statistics) {
+                Rprintf("%s", ode_solver_statistics_report(solver_stats).c_str());
+            }
+        }
+
+        SEXP result_df = PROTECT(data_frame_from_result(result));
+
+        if (skip_unchanged) {
+            Rf_setAttrib(result_df, Rf_install("module_run_counts"),
+                         run_counts_list(incremental_mcs));
+        }
+
+        if (record_timing) {
+            Rf_setAttrib(result_df, Rf_install("module_timing"),
+                         timing_list(timed_mcs, instructions.available()));
+        }
+
+        if (record_solver_statistics) {
+            Rf_setAttrib(result_df, Rf_install("ode_solver_statistics"),
+                         ode_solver_statistics_list(solver_stats));
         }
 
-        return list_from_map(result);
+        UNPROTECT(1);
+        return result_df;
     } catch (std::exception const& e) {
         Rf_error("%s", string(string("Caught exception in R_run_biocro: ") + e.what()).c_str());
     } catch (...) {
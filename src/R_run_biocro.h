@@ -14,6 +14,10 @@ extern "C" SEXP R_run_biocro(
     SEXP solver_adaptive_rel_error_tol,
     SEXP solver_adaptive_abs_error_tol,
     SEXP solver_adaptive_max_steps,
-    SEXP verbose);
+    SEXP quantities_to_record,
+    SEXP verbose,
+    SEXP skip_unchanged_modules,
+    SEXP time_modules,
+    SEXP solver_statistics);
 
 #endif
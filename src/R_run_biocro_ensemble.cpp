@@ -0,0 +1,235 @@
+#include <string>
+#include <vector>
+#include <atomic>                          // for std::atomic
+#include <memory>                          // for std::unique_ptr
+#include <thread>                          // for std::thread
+#include <stdexcept>                       // for std::runtime_error
+#include <exception>                       // for std::exception, std::exception_ptr
+#include <Rinternals.h>                    // for Rf_error and Rprintf
+#include "framework/R_helper_functions.h"  // for map_from_list, map_vector_from_list, mc_vector_from_list, make_vector
+#include "framework/state_map.h"           // for state_map, state_vector_map, string_vector
+#include "framework/module_creator.h"      // for mc_vector
+#include "framework/biocro_simulation.h"
+#include "R_simulation_result.h"          // for select_quantities, data_frame_from_result
+#include "module_trace.h"                 // for module_trace_enabled, trace_modules, record_trace_event
+#include "R_run_biocro_ensemble.h"
+
+using std::string;
+using std::vector;
+
+namespace
+{
+/**
+ * @brief Holds everything that is shared by all members of an ensemble: the
+ * converted drivers and module creators, the base initial values and
+ * parameters, the ODE solver settings, and a dense column-major table of
+ * member-specific values.
+ *
+ * All R objects are converted to C++ objects once, when the ensemble is
+ * constructed, so that running a member does not require any calls into R.
+ */
+struct ensemble_definition {
+    state_map initial_values;
+    state_map parameters;
+    state_vector_map drivers;
+    mc_vector direct_mcs;
+    mc_vector differential_mcs;
+    string solver_type;
+    double output_step_size;
+    double adaptive_rel_error_tol;
+    double adaptive_abs_error_tol;
+    int adaptive_max_steps;
+
+    size_t n_members;
+    string_vector member_value_names;
+    string_vector record_patterns;
+    vector<bool> member_value_is_initial_value;
+    double const* member_values;  // column-major, n_members x member_value_names.size()
+
+    /**
+     * @brief Runs one member of the ensemble. Each column of the member
+     * table overrides the initial value or parameter with the same name.
+     */
+    state_vector_map run_member(size_t i) const
+    {
+        state_map iv = initial_values;
+        state_map p = parameters;
+
+        for (size_t j = 0; j < member_value_names.size(); ++j) {
+            state_map& target = member_value_is_initial_value[j] ? iv : p;
+            target[member_value_names[j]] = member_values[i + j * n_members];
+        }
+
+        biocro_simulation gro(iv, p, drivers, direct_mcs, differential_mcs,
+                              solver_type, output_step_size,
+                              adaptive_rel_error_tol, adaptive_abs_error_tol,
+                              adaptive_max_steps);
+
+        record_trace_event("simulation", "simulation", 'B');
+        state_vector_map result = gro.run_simulation();
+        record_trace_event("simulation", "simulation", 'E');
+
+        select_quantities(result, record_patterns);
+        return result;
+    }
+
+    /**
+     * @brief Runs all members of the ensemble using up to `n_threads` worker
+     * threads, storing the result for member `i` in `results[i]`, and returns
+     * the number of threads that were actually used.
+     *
+     * Members are handed out one at a time from a shared atomic counter, so a
+     * thread that finishes a short simulation immediately picks up the next
+     * unclaimed member. Each worker builds its own simulation objects, while
+     * the drivers, module creators, and base values are only read, so no
+     * locking is required. Exceptions are captured for each member and
+     * rethrown on the calling thread after all workers have finished, since
+     * they cannot safely propagate out of a worker.
+     *
+     * No more threads are started than there are members, and when at most one
+     * thread is needed the members are run on the calling thread.
+     */
+    size_t run_all(size_t n_threads, vector<state_vector_map>& results) const
+    {
+        results.assign(n_members, state_vector_map{});
+        vector<std::exception_ptr> errors(n_members);
+        std::atomic<size_t> next_member(0);
+
+        auto worker = [&]() {
+            for (size_t i = next_member++; i < n_members; i = next_member++) {
+                try {
+                    results[i] = run_member(i);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        if (n_threads > n_members) {
+            n_threads = n_members;
+        }
+
+        if (n_threads <= 1) {
+            n_threads = 1;
+            worker();
+        } else {
+            vector<std::thread> pool;
+            for (size_t t = 0; t < n_threads; ++t) {
+                pool.emplace_back(worker);
+            }
+            for (std::thread& thread : pool) {
+                thread.join();
+            }
+        }
+
+        for (std::exception_ptr const& e : errors) {
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+
+        return n_threads;
+    }
+};
+
+}  // namespace
+
+extern "C" {
+
+SEXP R_run_biocro_ensemble(
+    SEXP initial_values,
+    SEXP parameters,
+    SEXP drivers,
+    SEXP direct_mc_vec,
+    SEXP differential_mc_vec,
+    SEXP solver_type,
+    SEXP solver_output_step_size,
+    SEXP solver_adaptive_rel_error_tol,
+    SEXP solver_adaptive_abs_error_tol,
+    SEXP solver_adaptive_max_steps,
+    SEXP member_values,
+    SEXP member_value_names,
+    SEXP n_threads,
+    SEXP quantities_to_record,
+    SEXP verbose)
+{
+    try {
+        ensemble_definition ens;
+
+        ens.initial_values = map_from_list(initial_values);
+        ens.parameters = map_from_list(parameters);
+        ens.drivers = map_vector_from_list(drivers);
+
+        ens.direct_mcs = mc_vector_from_list(direct_mc_vec);
+        ens.differential_mcs = mc_vector_from_list(differential_mc_vec);
+
+        // If a trace is being recorded, wrap all of the modules so each of
+        // their runs is added to it; the events from each worker thread are
+        // kept separately
+        std::vector<std::unique_ptr<traced_module_creator>> traced_mcs;
+        if (module_trace_enabled()) {
+            trace_modules(ens.direct_mcs, ens.differential_mcs, traced_mcs);
+        }
+
+        bool loquacious = LOGICAL(VECTOR_ELT(verbose, 0))[0];
+        size_t num_threads = (size_t)REAL(n_threads)[0];
+        ens.solver_type = CHAR(STRING_ELT(solver_type, 0));
+        ens.output_step_size = REAL(solver_output_step_size)[0];
+        ens.adaptive_rel_error_tol = REAL(solver_adaptive_rel_error_tol)[0];
+        ens.adaptive_abs_error_tol = REAL(solver_adaptive_abs_error_tol)[0];
+        ens.adaptive_max_steps = (int)REAL(solver_adaptive_max_steps)[0];
+
+        ens.member_value_names = make_vector(member_value_names);
+        ens.record_patterns = make_vector(quantities_to_record);
+        ens.n_members = Rf_nrows(member_values);
+        ens.member_values = REAL(member_values);
+
+        if ((size_t)Rf_ncols(member_values) != ens.member_value_names.size()) {
+            throw std::runtime_error(
+                "The number of member value names does not match the "
+                "number of columns in the member value matrix");
+        }
+
+        // Decide once whether each column refers to an initial value or a
+        // parameter
+        for (string const& name : ens.member_value_names) {
+            if (ens.initial_values.count(name) > 0) {
+                ens.member_value_is_initial_value.push_back(true);
+            } else if (ens.parameters.count(name) > 0) {
+                ens.member_value_is_initial_value.push_back(false);
+            } else {
+                throw std::runtime_error(
+                    string("The ensemble quantity `") + name +
+                    string("` is not one of the initial values or parameters"));
+            }
+        }
+
+        // No R API functions may be called while the members are running,
+        // since R is not thread-safe; the results are converted to R objects
+        // afterwards on this thread
+        SEXP result = PROTECT(Rf_allocVector(VECSXP, ens.n_members));
+
+        if (ens.drivers.begin()->second.size() > 0) {
+            vector<state_vector_map> member_results;
+            size_t const threads_used = ens.run_all(num_threads, member_results);
+
+            for (size_t i = 0; i < ens.n_members; ++i) {
+                SET_VECTOR_ELT(result, i, data_frame_from_result(member_results[i]));
+            }
+
+            if (loquacious) {
+                Rprintf("Ran %lu ensemble members using %lu thread(s)\n",
+                        (unsigned long)ens.n_members, (unsigned long)threads_used);
+            }
+        }
+
+        UNPROTECT(1);
+        return result;
+    } catch (std::exception const& e) {
+        Rf_error("%s", string(string("Caught exception in R_run_biocro_ensemble: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_run_biocro_ensemble.");
+    }
+}
+
+}  // extern "C"
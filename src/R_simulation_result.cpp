@@ -0,0 +1,143 @@
+#include <algorithm>                       // for std::copy
+#include <iterator>                        // for std::next
+#include <string>
+#include <vector>
+#include <stdexcept>                       // for std::runtime_error
+#include <Rinternals.h>                    // for SEXP, PROTECT, Rf_allocVector, etc
+#include "framework/state_map.h"           // for state_vector_map
+#include "R_simulation_result.h"
+
+using std::string;
+using std::vector;
+
+/**
+ *  @brief Determines whether a quantity name matches a pattern, where `*` in
+ *         the pattern matches any sequence of characters (including an empty
+ *         one) and `?` matches any single character.
+ *
+ *  @details A pattern without wildcards only matches the identical name. When
+ *           a mismatch occurs after a `*`, the match is retried with the `*`
+ *           consuming one more character, so the check takes at most
+ *           `pattern.size() * name.size()` steps.
+ */
+bool quantity_name_matches(string const& pattern, string const& name)
+{
+    size_t p = 0;
+    size_t n = 0;
+    size_t star = string::npos;
+    size_t star_n = 0;
+
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++p;
+            ++n;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_n = n;
+        } else if (star != string::npos) {
+            p = star + 1;
+            n = ++star_n;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+
+    return p == pattern.size();
+}
+
+/**
+ *  @brief Removes all quantities from a simulation result except `time` and
+ *         those matching at least one of the patterns.
+ *
+ *  @details If `patterns` is empty, all quantities are kept. Patterns may use
+ *           the wildcards described in `quantity_name_matches()`. A pattern
+ *           without wildcards must exactly match one of the quantities in the
+ *           result; otherwise an exception is thrown, since this most likely
+ *           indicates a typo.
+ */
+void select_quantities(state_vector_map& result, string_vector const& patterns)
+{
+    if (patterns.empty()) {
+        return;
+    }
+
+    for (string const& pattern : patterns) {
+        if (pattern.find_first_of("*?") == string::npos &&
+            result.count(pattern) == 0) {
+            throw std::runtime_error(
+                string("The quantity `") + pattern +
+                string("` was requested for recording, but it is not ") +
+                string("included in the simulation"));
+        }
+    }
+
+    for (auto it = result.begin(); it != result.end();) {
+        bool keep = it->first == "time";
+
+        for (size_t i = 0; !keep && i < patterns.size(); ++i) {
+            keep = quantity_name_matches(patterns[i], it->first);
+        }
+
+        it = keep ? std::next(it) : result.erase(it);
+    }
+}
+
+/**
+ *  @brief Converts the result of a simulation into an R data frame.
+ *
+ *  @details Each column of the data frame is allocated at its final size and
+ *           filled with a single copy from the corresponding C++ vector, which
+ *           is then released to limit peak memory usage. The `names`,
+ *           `row.names`, and `class` attributes are set directly, so the
+ *           result does not need to be passed through `as.data.frame` in R,
+ *           which would otherwise check and copy every column again. The
+ *           compact `row.names` form `c(NA, -nrow)` is the same one used by
+ *           R itself for data frames with automatic row names.
+ *
+ *  @param [in,out] result A `state_vector_map` where every element has the
+ *                  same length; its elements are cleared by this function.
+ *
+ *  @return An R data frame with one column for each element of `result`.
+ */
+SEXP data_frame_from_result(state_vector_map& result)
+{
+    size_t const ncol = result.size();
+    size_t const nrow = ncol > 0 ? result.begin()->second.size() : 0;
+
+    SEXP df = PROTECT(Rf_allocVector(VECSXP, ncol));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, ncol));
+
+    size_t i = 0;
+    for (auto& x : result) {
+        if (x.second.size() != nrow) {
+            UNPROTECT(2);
+            throw std::runtime_error(
+                string("The simulation result for `") + x.first +
+                string("` does not have the same length as the other quantities"));
+        }
+
+        SEXP column = PROTECT(Rf_allocVector(REALSXP, nrow));
+        std::copy(x.second.begin(), x.second.end(), REAL(column));
+        SET_VECTOR_ELT(df, i, column);
+        SET_STRING_ELT(names, i, Rf_mkChar(x.first.c_str()));
+        UNPROTECT(1);
+
+        vector<double>().swap(x.second);
+        ++i;
+    }
+
+    SEXP row_names = PROTECT(Rf_allocVector(INTSXP, 2));
+    INTEGER(row_names)[0] = NA_INTEGER;
+    INTEGER(row_names)[1] = -(int)nrow;
+
+    Rf_setAttrib(df, R_NamesSymbol, names);
+    Rf_setAttrib(df, R_RowNamesSymbol, row_names);
+    Rf_setAttrib(df, R_ClassSymbol, Rf_mkString("data.frame"));
+
+    UNPROTECT(3);
+    return df;
+}
@@ -0,0 +1,14 @@
+#ifndef R_SIMULATION_RESULT_H
+#define R_SIMULATION_RESULT_H
+
+#include <string>
+#include <Rinternals.h>             // for SEXP
+#include "framework/state_map.h"  // for state_vector_map, string_vector
+
+bool quantity_name_matches(std::string const& pattern, std::string const& name);
+
+void select_quantities(state_vector_map& result, string_vector const& patterns);
+
+SEXP data_frame_from_result(state_vector_map& result);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef DIRECT_MODULE_EVALUATOR_H
+#define DIRECT_MODULE_EVALUATOR_H
+
+#include <string>
+#include <vector>
+#include <memory>                      // for unique_ptr
+#include "framework/state_map.h"       // for state_map, state_vector_map, string_vector
+#include "framework/module_creator.h"  // for module_creator
+#include "framework/module.h"          // for module
+
+/**
+ *  @brief Runs a set of direct modules in order, using the supplied parameters
+ *  and the values of some time-dependent quantities (such as drivers) at one
+ *  point in time, and returns the resulting values of their output quantities.
+ *
+ *  @details The modules must be ordered so each one only depends on the
+ *  parameters, the time-dependent quantities, and the modules before it.
+ */
+class direct_module_evaluator
+{
+   public:
+    direct_module_evaluator(
+        state_map const& parameters,
+        state_vector_map const& drivers,
+        std::vector<module_creator*> const& mcs)
+        : quantities{parameters}
+    {
+        for (auto const& d : drivers) {
+            quantities[d.first] = d.second[0];
+            driver_names.push_back(d.first);
+        }
+
+        for (module_creator* mc : mcs) {
+            for (std::string const& q : mc->get_outputs()) {
+                quantities[q] = 0.0;
+                output_names.push_back(q);
+            }
+        }
+
+        // All quantities now exist, so references to them will remain valid
+        // while the modules are created and run
+        for (module_creator* mc : mcs) {
+            modules.push_back(mc->create_module(quantities, &quantities));
+        }
+    }
+
+    // Sets the driver values using a linear interpolation between rows `i`
+    // and `i + 1`, where `fraction` is between 0 and 1
+    void set_drivers(state_vector_map const& drivers, size_t i, double fraction)
+    {
+        for (std::string const& name : driver_names) {
+            std::vector<double> const& values = drivers.at(name);
+            quantities[name] = fraction == 0.0
+                                   ? values[i]
+                                   : values[i] + fraction * (values[i + 1] - values[i]);
+        }
+    }
+
+    void run() const
+    {
+        for (auto const& m : modules) {
+            m->run();
+        }
+    }
+
+    double get(std::string const& name) const { return quantities.at(name); }
+
+    string_vector const& get_output_names() const { return output_names; }
+
+   private:
+    state_map quantities;
+    string_vector driver_names;
+    string_vector output_names;
+    std::vector<std::unique_ptr<module>> modules;
+};
+
+#endif
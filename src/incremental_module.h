@@ -0,0 +1,139 @@
+#ifndef INCREMENTAL_MODULE_H
+#define INCREMENTAL_MODULE_H
+
+#include <string>
+#include <vector>
+#include <memory>                      // for unique_ptr
+#include <cstring>                     // for std::memcmp
+#include "framework/state_map.h"       // for state_map, string_vector
+#include "framework/module_creator.h"  // for module_creator
+#include "framework/module.h"          // for module, direct_module, get_ip, get_op
+
+/**
+ *  @brief The number of times an `incremental_module` ran its wrapped module
+ *  and the number of times it skipped it.
+ */
+struct module_run_counts {
+    unsigned long runs = 0;
+    unsigned long skips = 0;
+};
+
+/**
+ *  @class incremental_module
+ *
+ *  @brief Wraps a direct module, only running it when the value of at least
+ *  one of its inputs has changed since the last time it ran.
+ *
+ *  @details Input values are compared bit by bit, so a module is skipped only
+ *  when it would have received exactly the same inputs, and therefore
+ *  calculated exactly the same outputs, as in its previous run. The outputs
+ *  from that run are stored and written again when the module is skipped, in
+ *  case the quantities have been modified elsewhere in the meantime (for
+ *  example, when a dynamical system is reset).
+ */
+class incremental_module : public direct_module
+{
+   public:
+    incremental_module(
+        std::unique_ptr<module> wrapped,
+        string_vector const& inputs,
+        string_vector const& outputs,
+        state_map const& input_quantities,
+        state_map* output_quantities,
+        module_run_counts& counts)
+        : direct_module(wrapped->requires_euler_ode_solver()),
+          wrapped{std::move(wrapped)},
+          counts(counts),
+          previous_inputs(inputs.size()),
+          previous_outputs(outputs.size())
+    {
+        for (std::string const& q : inputs) {
+            input_ptrs.push_back(get_ip(input_quantities, q));
+        }
+
+        for (std::string const& q : outputs) {
+            output_ptrs.push_back(get_op(output_quantities, q));
+        }
+    }
+
+   private:
+    std::unique_ptr<module> const wrapped;
+    module_run_counts& counts;
+
+    std::vector<double const*> input_ptrs;
+    std::vector<double*> output_ptrs;
+
+    // Values from the most recent run of the wrapped module
+    mutable bool has_run = false;
+    mutable std::vector<double> previous_inputs;
+    mutable std::vector<double> previous_outputs;
+
+    void do_operation() const
+    {
+        bool inputs_changed = !has_run;
+
+        for (size_t i = 0; i < input_ptrs.size(); ++i) {
+            if (std::memcmp(input_ptrs[i], &previous_inputs[i], sizeof(double)) != 0) {
+                previous_inputs[i] = *input_ptrs[i];
+                inputs_changed = true;
+            }
+        }
+
+        if (inputs_changed) {
+            wrapped->run();
+            for (size_t i = 0; i < output_ptrs.size(); ++i) {
+                previous_outputs[i] = *output_ptrs[i];
+            }
+            has_run = true;
+            ++counts.runs;
+        } else {
+            for (size_t i = 0; i < output_ptrs.size(); ++i) {
+                update(output_ptrs[i], previous_outputs[i]);
+            }
+            ++counts.skips;
+        }
+    }
+};
+
+/**
+ *  @class incremental_module_creator
+ *
+ *  @brief A `module_creator` that wraps the modules created by another one in
+ *  `incremental_module` objects and keeps count of how often they run.
+ *
+ *  @details The wrapped creator is not owned by this object, and must outlive
+ *  it. Likewise, this object must outlive any modules it creates.
+ */
+class incremental_module_creator : public module_creator
+{
+   public:
+    explicit incremental_module_creator(module_creator* wrapped)
+        : wrapped{wrapped}
+    {
+    }
+
+    string_vector get_inputs() { return wrapped->get_inputs(); }
+    string_vector get_outputs() { return wrapped->get_outputs(); }
+    std::string get_name() { return wrapped->get_name(); }
+
+    std::unique_ptr<module> create_module(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+    {
+        return std::unique_ptr<module>(new incremental_module(
+            wrapped->create_module(input_quantities, output_quantities),
+            wrapped->get_inputs(),
+            wrapped->get_outputs(),
+            input_quantities,
+            output_quantities,
+            counts));
+    }
+
+    module_run_counts const& get_counts() const { return counts; }
+
+   private:
+    module_creator* const wrapped;
+    module_run_counts counts;
+};
+
+#endif
@@ -14,11 +14,15 @@
 #include <R_ext/Rdynload.h>    // for R_CallMethodDef, R_registerRoutines, R_forceSymbols
 #include <R_ext/Visibility.h>  // for attribute_visible
 
+#include "R_driver_modules.h"
 #include "R_dynamical_system.h"
 #include "R_get_all_ode_solvers.h"
 #include "R_module_library.h"
+#include "R_module_trace.h"
 #include "R_modules.h"
+#include "R_performance_counters.h"
 #include "R_run_biocro.h"
+#include "R_run_biocro_ensemble.h"
 #include "R_system_derivatives.h"
 #include "R_framework_version.h"
 
@@ -28,9 +32,15 @@ static const R_CallMethodDef callMethods[] = {
     {"R_get_all_modules",                  (DL_FUNC) &R_get_all_modules,                  0},
     {"R_get_all_ode_solvers",              (DL_FUNC) &R_get_all_ode_solvers,              0},
     {"R_get_all_quantities",               (DL_FUNC) &R_get_all_quantities,               0},
+    {"R_leaf_solver_statistics",           (DL_FUNC) &R_leaf_solver_statistics,           2},
     {"R_module_creators",                  (DL_FUNC) &R_module_creators,                  1},
     {"R_module_info",                      (DL_FUNC) &R_module_info,                      2},
-    {"R_run_biocro",                       (DL_FUNC) &R_run_biocro,                       11},
+    {"R_performance_counters",             (DL_FUNC) &R_performance_counters,             1},
+    {"R_precompute_driver_modules",        (DL_FUNC) &R_precompute_driver_modules,        3},
+    {"R_run_biocro",                       (DL_FUNC) &R_run_biocro,                       15},
+    {"R_run_biocro_ensemble",              (DL_FUNC) &R_run_biocro_ensemble,              15},
+    {"R_start_module_trace",               (DL_FUNC) &R_start_module_trace,               1},
+    {"R_stop_module_trace",                (DL_FUNC) &R_stop_module_trace,                1},
     {"R_system_derivatives",               (DL_FUNC) &R_system_derivatives,               6},
     {"R_validate_dynamical_system_inputs", (DL_FUNC) &R_validate_dynamical_system_inputs, 6},
     {"R_framework_version",                (DL_FUNC) &R_framework_version,                0},
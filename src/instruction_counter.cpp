@@ -0,0 +1,53 @@
+#include "instruction_counter.h"
+
+#if defined(BIOCRO_COUNT_INSTRUCTIONS) && defined(__linux__)
+
+#include <cstring>             // for std::memset
+#include <linux/perf_event.h>  // for perf_event_attr, PERF_TYPE_HARDWARE, etc
+#include <sys/syscall.h>       // for __NR_perf_event_open
+#include <unistd.h>            // for syscall, read, close
+
+namespace
+{
+int open_instruction_counter()
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // Count instructions for the calling thread on any CPU
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+}  // namespace
+
+instruction_counter::instruction_counter() : fd{open_instruction_counter()} {}
+
+instruction_counter::~instruction_counter()
+{
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+long long instruction_counter::read() const
+{
+    long long count = 0;
+    if (fd < 0 || ::read(fd, &count, sizeof(count)) != sizeof(count)) {
+        return 0;
+    }
+    return count;
+}
+
+#else
+
+instruction_counter::instruction_counter() : fd{-1} {}
+
+instruction_counter::~instruction_counter() {}
+
+long long instruction_counter::read() const { return 0; }
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef INSTRUCTION_COUNTER_H
+#define INSTRUCTION_COUNTER_H
+
+/**
+ *  @class instruction_counter
+ *
+ *  @brief Counts the instructions retired by the calling thread, using a
+ *  hardware performance counter.
+ *
+ *  @details Hardware counters are only used when BioCro is compiled on Linux
+ *  with `BIOCRO_COUNT_INSTRUCTIONS` defined, and even then the operating
+ *  system may not allow access to them. In all other cases, `available()`
+ *  returns `false` and `read()` returns zero.
+ */
+class instruction_counter
+{
+   public:
+    instruction_counter();
+    ~instruction_counter();
+    instruction_counter(instruction_counter const&) = delete;
+    instruction_counter& operator=(instruction_counter const&) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    // Returns the number of instructions retired since the counter was
+    // created
+    long long read() const;
+
+   private:
+    int fd;  // file descriptor for the counter, or -1 if there is none
+};
+
+#endif
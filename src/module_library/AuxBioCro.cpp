@@ -62,15 +62,15 @@ double poisson_density(int x, double lambda)
  * Preconditions:
  *     `WindSpeed` is non-negative.
  *     `LAI` is non-negative
- *     `wind_speed_profile` is a vector of size at most MAXLAY.
+ *     `nlayers` is at least 1.
+ *     `wind_speed_profile` is an array with `nlayers` elements.
  */
-void WINDprof(double WindSpeed, double LAI, vector<double>& wind_speed_profile)
+void WINDprof(double WindSpeed, double LAI, int nlayers, double* wind_speed_profile)
 {
-    auto nlayers = wind_speed_profile.size();
     constexpr double k = 0.7;
     double LI = LAI / nlayers;
 
-    for (vector<double>::size_type i = 0; i < nlayers; ++i) {
+    for (int i = 0; i < nlayers; ++i) {
         double CumLAI = LI * (i + 1);
         wind_speed_profile[i] = WindSpeed * exp(-k * (CumLAI - LI));
     }
@@ -82,7 +82,7 @@ void WINDprof(double WindSpeed, double LAI, vector<double>& wind_speed_profile)
  *
  * @param[in] RH relative humidity just above the canopy `(0 <= RH <= 1)`
  *
- * @param[in] nlayers number of layers in the canopy `(1 <= nlayers <= MAXLAY)`
+ * @param[in] nlayers number of layers in the canopy `(1 <= nlayers)`
  *
  * @param[out] relative_humidity_profile array of relative humidity values
  * expressed as fractions between 0 and 1, where the value at index `i`
@@ -169,8 +169,8 @@ void RHprof(double RH, int nlayers, double* relative_humidity_profile)
     if (RH > 1 || RH < 0) {
         throw std::out_of_range("RH must be between 0 and 1.");
     }
-    if (nlayers < 1 || nlayers > MAXLAY) {
-        throw std::out_of_range("nlayers must be at least 1 but no more than MAXLAY.");
+    if (nlayers < 1) {
+        throw std::out_of_range("nlayers must be at least 1.");
     }
 
     const double kh = 1 - RH;
@@ -182,11 +182,10 @@ void RHprof(double RH, int nlayers, double* relative_humidity_profile)
     }
 }
 
-void LNprof(double LeafN, double LAI, double kpLN, vector<double>& leafN_profile)
+void LNprof(double LeafN, double LAI, double kpLN, int nlayers, double* leafN_profile)
 {
-    auto nlayers = leafN_profile.size();
     double LI = LAI / nlayers;
-    for (vector<double>::size_type i = 0; i < nlayers; ++i) {
+    for (int i = 0; i < nlayers; ++i) {
         double CumLAI = LI * (i + 1);
         leafN_profile[i] = LeafN * exp(-kpLN * (CumLAI - LI));
     }
@@ -416,8 +415,9 @@ ws_str watstr(
 
 /* Function to simulate the multilayer behavior of soil water. In the
    future this could be coupled with Campbell (BASIC) ideas to
-   esitmate water potential. */
-soilML_str soilML(
+   esitmate water potential. The results are stored in `soil_profile`, which
+   is provided by the caller so that its per-layer vectors can be reused. */
+void soilML(
     double precipit,
     double transp,
     double* cws,
@@ -449,16 +449,19 @@ soilML_str soilML(
     double soil_reflectance,
     double soil_transmission,
     double specific_heat_of_air,
-    double par_energy_content)
+    double par_energy_content,
+    soilML_str& soil_profile)
 {
     constexpr double g = 9.8; /* m / s-2  ##  http://en.wikipedia.org/wiki/Standard_gravity */
 
-    soilML_str return_value;
+    soil_profile.resize(layers);
 
     /* Crude empirical relationship between root biomass and rooting depth*/
     double rootDepth = fmin(rootDB * rsdf, soildepth);
 
-    rd_str root_distribution = rootDist(layers, rootDepth, &depths[0], rfl);
+    /* The root distribution is stored in `soil_profile.rootDist` until each
+       layer's element is replaced by the root biomass at that depth */
+    rootDist(layers, rootDepth, &depths[0], rfl, soil_profile.rootDist.data());
 
     /* unit conversion for precip */
     double oldWaterIn = 0.0;
@@ -533,8 +536,9 @@ soilML_str soilML(
         }
 
         /* Root Biomass */
-        double rootATdepth = rootDB * root_distribution.rootDist[i];
-        return_value.rootDist[i] = rootATdepth;
+        double const root_fraction = soil_profile.rootDist[i];
+        double rootATdepth = rootDB * root_fraction;
+        soil_profile.rootDist[i] = rootATdepth;
         /* Plant available water is only between current water status and permanent wilting point */
         /* Plant available water */
         double pawha = (aw - soil_wilting_point * layerDepth) * 1e4;
@@ -558,14 +562,14 @@ soilML_str soilML(
             /* I assume that crop transpiration is distributed simlarly to
                root density.  In other words the crop takes up water proportionally
                to the amount of root in each respective layer.*/
-            Ctransp = transp * root_distribution.rootDist[0];
+            Ctransp = transp * root_fraction;
             EvapoTra = Ctransp + Sevap;
             constexpr double density_of_water_at_20_celcius = 0.9982;  // Mg m^-3.
             Newpawha = pawha - EvapoTra / density_of_water_at_20_celcius;
             /* The first term in the rhs pawha is the m3 of water available in this layer.
                EvapoTra is the Mg H2O ha-1 of transpired and evaporated water. 1/0.9882 converts from Mg to m3 */
         } else {
-            Ctransp = transp * root_distribution.rootDist[i];
+            Ctransp = transp * root_fraction;
             EvapoTra = Ctransp;
             Newpawha = pawha - (EvapoTra + oldEvapoTra);
         }
@@ -579,7 +583,7 @@ soilML_str soilML(
         double awc = Newpawha / 1e4 / layerDepth + soil_wilting_point;
 
         /* This might look like a weird place to populate the structure, but is more convenient*/
-        return_value.cws[i] = awc;
+        soil_profile.cws[i] = awc;
 
         // To-do: Replace this block with a call to compute_wsPhoto.
         /* three different type of equations for modeling the effect of water stress on vmax and leaf area expansion.
@@ -621,17 +625,15 @@ soilML_str soilML(
         drainage = waterIn;
         /* Need to convert to units used in the Parton et al 1988 paper. */
         /* The data comes in mm/hr and it needs to be in cm/month */
-        return_value.Nleach = drainage * 0.1 * (1 / 24 * 30) / (1e3 * physical_constants::molar_mass_of_water * (0.2 + 0.7 * soil_sand_content));
+        soil_profile.Nleach = drainage * 0.1 * (1 / 24 * 30) / (1e3 * physical_constants::molar_mass_of_water * (0.2 + 0.7 * soil_sand_content));
     } else {
-        return_value.Nleach = 0.0;
+        soil_profile.Nleach = 0.0;
     }
 
-    return_value.rcoefPhoto = (wsPhotoCol / layers);
-    return_value.drainage = drainage;
-    return_value.rcoefSpleaf = (LeafWSCol / layers);
-    return_value.SoilEvapo = Sevap;
-
-    return return_value;
+    soil_profile.rcoefPhoto = (wsPhotoCol / layers);
+    soil_profile.drainage = drainage;
+    soil_profile.rcoefSpleaf = (LeafWSCol / layers);
+    soil_profile.SoilEvapo = Sevap;
 }
 
 /**
@@ -752,19 +754,20 @@ seqRD_str seqRootDepth(double to, int lengthOut)
     double by = to / lengthOut;
 
     seqRD_str result;
+    result.rootDepths.resize(lengthOut + 1);
     for (int i = 0; i <= lengthOut; ++i) {
         result.rootDepths[i] = i * by;
     }
     return result;
 }
 
-rd_str rootDist(int n_layers, double rootDepth, double* depths, double rfl)
+void rootDist(int n_layers, double rootDepth, double* depths, double rfl, double* rootDist)
 {
     /*
      * Calculate the fraction of total root mass for each layer in `depths` assuming the mass
      * is follows a Poisson distribution along the depth.
      *
-     * Returns a struct with one array of size `n_layers`.
+     * The results are stored in `rootDist`, a caller-provided array of size `n_layers`.
      * Each element in the array is the fraction of total root mass in that layer.
      * The sum of all elements of the result equals 1.
      */
@@ -772,7 +775,6 @@ rd_str rootDist(int n_layers, double rootDepth, double* depths, double rfl)
     double layerDepth = 0.0;
     double CumLayerDepth = 0.0;
     int CumRootDist = 1;
-    vector<double> rootDist(n_layers);
     double cumulative_a = 0.0;
 
     for (int i = 0; i < n_layers; ++i) {
@@ -799,9 +801,7 @@ rd_str rootDist(int n_layers, double rootDepth, double* depths, double rfl)
         }
     }
 
-    rd_str result;
     for (int k = 0; k < n_layers; ++k) {
-        result.rootDist[k] = rootDist[k] / cumulative_a;
+        rootDist[k] /= cumulative_a;
     }
-    return result;
 }
@@ -1,6 +1,7 @@
 #ifndef AUXBIOCRO_H
 #define AUXBIOCRO_H
 
+#include <cstddef>  // for size_t
 #include <map>
 #include <vector>
 #include "../framework/constants.h" // for ideal_gas_constant
@@ -9,9 +10,6 @@
 /* routines in the BioCro package. These are functions needed */
 /* internally. The normal user will not need them */
 
-
-#define MAXLAY    200 /* Maximum number of layers */
-
 struct ET_Str {
   double TransR;
   double EPenman;
@@ -30,11 +28,19 @@ struct ws_str {
 struct soilML_str {
   double rcoefPhoto;
   double rcoefSpleaf;
-  double cws[MAXLAY];
+  std::vector<double> cws;       /* one element per soil layer */
   double drainage;
   double Nleach;
   double SoilEvapo;
-  double rootDist[MAXLAY];
+  std::vector<double> rootDist;  /* one element per soil layer */
+
+  // Sets the number of soil layers; memory is only allocated when the new
+  // number of layers is larger than any previous one
+  void resize(size_t layers)
+  {
+    cws.resize(layers);
+    rootDist.resize(layers);
+  }
 };
 
 
@@ -48,16 +54,12 @@ struct dbp_str{
 };
 
 struct seqRD_str{
-  double rootDepths[MAXLAY+1];
+  std::vector<double> rootDepths; /* lengthOut + 1 elements */
 };
 
 seqRD_str seqRootDepth(double to, int lengthOut);
 
-struct rd_str{
-  double rootDist[MAXLAY];
-};
-
-rd_str rootDist(int layer, double rootDepth, double *depths, double rfl);
+void rootDist(int layer, double rootDepth, double *depths, double rfl, double *rootDist);
 
 struct frostParms {
   double leafT0;
@@ -98,7 +100,7 @@ struct crop_phenology {
       }leaf,stem,root,rhiz;
 };
 
-void LNprof(double LeafN, double LAI, double kpLN, std::vector<double>& leafNla);
+void LNprof(double LeafN, double LAI, double kpLN, int nlayers, double* leafNla);
 
 #endif
 
@@ -2,10 +2,11 @@
 #include "CanAC.h"
 #include "../framework/constants.h"  // for molar_mass_of_water, molar_mass_of_glucose
 #include "BioCro.h"                  // for WINDprof
-#include "c4photo.h"                 // for c4photoC
+#include "c4photo.h"                 // for c4photoC_batch
+#include "identical_values.h"        // for identical_values
 #include "leaf_energy_balance.h"     // for leaf_energy_balance
 #include "lightME.h"                 // for lightME
-#include "sunML.h"                   // for sunML
+#include "sunML.h"                   // for sunML_cache
 
 canopy_photosynthesis_outputs CanAC(
     const nitroParms& nitroP,
@@ -45,9 +46,12 @@ canopy_photosynthesis_outputs CanAC(
     double Vmax,                    // micromol / m^2 / s
     double WindSpeed,               // m / s
     int lnfun,                      // dimensionless switch
-    int nlayers                     // dimensionless
-)
+    int nlayers,                    // dimensionless
+    sunML_cache& light_cache,
+    scratch_arena& scratch)
 {
+    scratch_arena::frame const frame(scratch);
+
     Light_model light_model = lightME(
         cosine_zenith_angle,
         atmospheric_pressure,
@@ -60,8 +64,10 @@ canopy_photosynthesis_outputs CanAC(
     double q_diff = light_model.diffuse_fraction * solarR;  // micromole / m^2 / s
 
     // Here we set `heightf = 1`. The value used for `heightf` does not matter,
-    // since the canopy height is not used anywhere in this function.
-    struct Light_profile light_profile = sunML(
+    // since the canopy height is not used anywhere in this function. The light
+    // profile is only recalculated when its inputs have changed since the
+    // previous call.
+    Light_profile const& light_profile = light_cache.get_profile(
         q_dir,
         q_diff,
         chil,
@@ -79,11 +85,11 @@ canopy_photosynthesis_outputs CanAC(
 
     double LAIc = LAI / nlayers;  // dimensionless
 
-    std::vector<double> wind_speed_profile(nlayers);
-    WINDprof(WindSpeed, LAI, wind_speed_profile);  // Modifies wind_speed_profile
+    auto wind_speed_profile = scratch.allocate<double>(nlayers);
+    WINDprof(WindSpeed, LAI, nlayers, wind_speed_profile.data());  // Modifies wind_speed_profile
 
-    std::vector<double> leafN_profile(nlayers);
-    LNprof(leafN, LAI, kpLN, leafN_profile);  // Modifies leafN_profile
+    auto leafN_profile = scratch.allocate<double>(nlayers);
+    LNprof(leafN, LAI, kpLN, nlayers, leafN_profile.data());  // Modifies leafN_profile
 
     double CanopyA{0.0};             // micromol / m^2 / s
     double GCanopyA{0.0};            // micromol / m^2 / s
@@ -95,6 +101,36 @@ canopy_photosynthesis_outputs CanAC(
 
     double gbw_guess{1.2};  // mol / m^2 / s
 
+    // The leaves are handled in three stages so that the photosynthesis
+    // calculations for all layers and leaf classes can be done together using
+    // `c4photoC_batch()`, which produces exactly the same results as calling
+    // `c4photoC()` for each leaf. Leaves are stored in the batch in layer
+    // order, with the sunlit leaves of each layer preceding the shaded leaves.
+    //
+    // When there is no direct light (for example, at night), the sunlit and
+    // shaded leaves in a layer receive the same light and therefore have
+    // identical inputs. In that case, only one batch position is used for the
+    // layer and its results are applied to both leaf classes, which halves the
+    // amount of work without changing the outputs. The batch position used for
+    // each leaf is stored in `leaf_slot`, where sunlit leaves in the layer with
+    // index `i` have index `2 * i` and shaded leaves have index `2 * i + 1`.
+    //
+    // For each leaf: first, estimate stomatal conductance by assuming the leaf
+    // has the same temperature as the air. Then, use energy balance to get a
+    // better temperature estimate using that value of stomatal conductance.
+    // Get the final estimate of stomatal conductance using the new value of the
+    // leaf temperature.
+    size_t const nleaves = 2 * nlayers;
+
+    c4photo_batch_inputs photo_inputs;
+    photo_inputs.allocate(scratch, nleaves);
+
+    auto absorbed_shortwave = scratch.allocate<double>(nleaves);  // J / m^2 / s
+    auto leaf_area = scratch.allocate<double>(nleaves);           // dimensionless
+    auto leaf_wind_speed = scratch.allocate<double>(nleaves);     // m / s
+    auto leaf_slot = scratch.allocate<size_t>(nleaves);
+    size_t nslots = 0;
+
     for (int i = 0; i < nlayers; ++i) {
         // Calculations that are the same for sunlit and shaded leaves
         int current_layer = nlayers - 1 - i;
@@ -117,85 +153,95 @@ canopy_photosynthesis_outputs CanAC(
 
         double layer_wind_speed = wind_speed_profile[current_layer];  // m / s
 
-        // Calculations for sunlit leaves. First, estimate stomatal conductance
-        // by assuming the leaf has the same temperature as the air. Then, use
-        // energy balance to get a better temperature estimate using that value
-        // of stomatal conductance. Get the final estimate of stomatal
-        // conductance using the new value of the leaf temperature.
-        double i_dir = light_profile.sunlit_incident_ppfd[current_layer];       // micromole / m^2 / s
-        double j_dir = light_profile.sunlit_absorbed_shortwave[current_layer];  // J / m^2 / s
-        double pLeafsun = light_profile.sunlit_fraction[current_layer];         // dimensionless. Fraction of LAI that is sunlit.
-        double Leafsun = LAIc * pLeafsun;                                       // dimensionless
-
-        double direct_gsw_estimate =
-            c4photoC(
-                i_dir, ambient_temperature, ambient_temperature,
-                RH, vmax1, Alpha, Kparm,
-                theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, upperT, lowerT,
-                gbw_guess)
-                .Gs;  // mol / m^2 / s
-
-        energy_balance_outputs et_direct = leaf_energy_balance(
-            absorbed_longwave,
-            j_dir,
-            atmospheric_pressure,
-            ambient_temperature,
-            gbw_canopy,
-            leafwidth,
-            RH,
-            direct_gsw_estimate,
-            layer_wind_speed);
-
-        double leaf_temperature_dir = ambient_temperature + et_direct.Deltat;  // degrees C
-
-        photosynthesis_outputs direct_photo =
-            c4photoC(
-                i_dir, leaf_temperature_dir, ambient_temperature,
-                RH, vmax1, Alpha, Kparm,
-                theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, upperT, lowerT,
-                et_direct.gbw_molecular);
-
-        // Calculations for shaded leaves. First, estimate stomatal conductance
-        // by assuming the leaf has the same temperature as the air. Then, use
-        // energy balance to get a better temperature estimate using that value
-        // of stomatal conductance. Get the final estimate of stomatal
-        // conductance using the new value of the leaf temperature.
-        double i_diff = light_profile.shaded_incident_ppfd[current_layer];       // micromole / m^2 / s
-        double j_diff = light_profile.shaded_absorbed_shortwave[current_layer];  // J / m^2 / s
-        double pLeafshade = light_profile.shaded_fraction[current_layer];        // dimensionless. Fraction of LAI that is shaded.
-        double Leafshade = LAIc * pLeafshade;                                    // dimensionless
-
-        double diffuse_gsw_estimate =
-            c4photoC(
-                i_diff, ambient_temperature, ambient_temperature,
-                RH, vmax1, Alpha, Kparm,
-                theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, upperT, lowerT,
-                gbw_guess)
-                .Gs;  // mol / m^2 / s
-
-        energy_balance_outputs et_diffuse = leaf_energy_balance(
+        size_t const sun = 2 * i;
+        size_t const shade = 2 * i + 1;
+
+        leaf_area[sun] = LAIc * light_profile.sunlit_fraction[current_layer];    // dimensionless
+        leaf_area[shade] = LAIc * light_profile.shaded_fraction[current_layer];  // dimensionless
+
+        double const sunlit_light = light_profile.sunlit_incident_ppfd[current_layer];           // micromole / m^2 / s
+        double const shaded_light = light_profile.shaded_incident_ppfd[current_layer];           // micromole / m^2 / s
+        double const sunlit_shortwave = light_profile.sunlit_absorbed_shortwave[current_layer];  // J / m^2 / s
+        double const shaded_shortwave = light_profile.shaded_absorbed_shortwave[current_layer];  // J / m^2 / s
+
+        // Sunlit leaves
+        size_t const first_slot = nslots;
+        leaf_slot[sun] = nslots++;
+        photo_inputs.Qp[leaf_slot[sun]] = sunlit_light;
+        absorbed_shortwave[leaf_slot[sun]] = sunlit_shortwave;
+
+        // Shaded leaves
+        if (identical_values(sunlit_light, shaded_light) &&
+            identical_values(sunlit_shortwave, shaded_shortwave)) {
+            leaf_slot[shade] = leaf_slot[sun];
+        } else {
+            leaf_slot[shade] = nslots++;
+            photo_inputs.Qp[leaf_slot[shade]] = shaded_light;
+            absorbed_shortwave[leaf_slot[shade]] = shaded_shortwave;
+        }
+
+        for (size_t k = first_slot; k < nslots; ++k) {
+            leaf_wind_speed[k] = layer_wind_speed;
+            photo_inputs.leaf_temperature[k] = ambient_temperature;
+            photo_inputs.ambient_temperature[k] = ambient_temperature;
+            photo_inputs.relative_humidity[k] = RH;
+            photo_inputs.vmax[k] = vmax1;
+            photo_inputs.alpha[k] = Alpha;
+            photo_inputs.kparm[k] = Kparm;
+            photo_inputs.theta[k] = theta;
+            photo_inputs.beta[k] = beta;
+            photo_inputs.Rd[k] = Rd;
+            photo_inputs.bb0[k] = b0;
+            photo_inputs.bb1[k] = b1;
+            photo_inputs.Gs_min[k] = Gs_min;
+            photo_inputs.StomaWS[k] = StomataWS;
+            photo_inputs.Ca[k] = Catm;
+            photo_inputs.atmospheric_pressure[k] = atmospheric_pressure;
+            photo_inputs.upperT[k] = upperT;
+            photo_inputs.lowerT[k] = lowerT;
+            photo_inputs.gbw[k] = gbw_guess;
+        }
+    }
+
+    photo_inputs.truncate(nslots);
+
+    // Estimate stomatal conductance at the air temperature
+    auto photo = scratch.allocate<photosynthesis_outputs>(nslots);
+    c4photoC_batch(photo_inputs, photo, scratch);
+
+    // Use energy balance to find the leaf temperatures
+    auto et = scratch.allocate<energy_balance_outputs>(nslots);
+    for (size_t k = 0; k < nslots; ++k) {
+        et[k] = leaf_energy_balance(
             absorbed_longwave,
-            j_diff,
+            absorbed_shortwave[k],
             atmospheric_pressure,
             ambient_temperature,
             gbw_canopy,
             leafwidth,
             RH,
-            diffuse_gsw_estimate,
-            layer_wind_speed);
-
-        double leaf_temperature_diff = ambient_temperature + et_diffuse.Deltat;  // degrees C
-
-        photosynthesis_outputs diffuse_photo =
-            c4photoC(
-                i_diff, leaf_temperature_diff, ambient_temperature,
-                RH, vmax1, Alpha, Kparm,
-                theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, upperT, lowerT,
-                et_diffuse.gbw_molecular);
+            photo[k].Gs,
+            leaf_wind_speed[k]);
+
+        photo_inputs.leaf_temperature[k] = ambient_temperature + et[k].Deltat;  // degrees C
+        photo_inputs.gbw[k] = et[k].gbw_molecular;                              // mol / m^2 / s
+    }
+
+    // Calculate photosynthesis at the new leaf temperatures
+    c4photoC_batch(photo_inputs, photo, scratch);
+
+    for (int i = 0; i < nlayers; ++i) {
+        size_t const sun = 2 * i;
+        size_t const shade = 2 * i + 1;
+
+        double const Leafsun = leaf_area[sun];      // dimensionless
+        double const Leafshade = leaf_area[shade];  // dimensionless
+
+        photosynthesis_outputs const& direct_photo = photo[leaf_slot[sun]];
+        photosynthesis_outputs const& diffuse_photo = photo[leaf_slot[shade]];
+
+        energy_balance_outputs const& et_direct = et[leaf_slot[sun]];
+        energy_balance_outputs const& et_diffuse = et[leaf_slot[shade]];
 
         // Combine sunlit and shaded leaves
         CanopyA += Leafsun * direct_photo.Assim + Leafshade * diffuse_photo.Assim;             // micromol / m^2 / s
@@ -3,6 +3,8 @@
 
 #include "AuxBioCro.h"                      // for nitroParms
 #include "canopy_photosynthesis_outputs.h"  // for canopy_photosynthesis_outputs
+#include "sunML.h"                          // for sunML_cache
+#include "scratch_arena.h"                  // for scratch_arena
 
 canopy_photosynthesis_outputs CanAC(
     const nitroParms& nitroP,
@@ -42,7 +44,8 @@ canopy_photosynthesis_outputs CanAC(
     double Vmax,                    // micromol / m^2 / s
     double WindSpeed,               // m / s
     int lnfun,                      // dimensionless switch
-    int nlayers                     // dimensionless
-);
+    int nlayers,                    // dimensionless
+    sunML_cache& light_cache,
+    scratch_arena& scratch);
 
 #endif
@@ -104,6 +104,49 @@ stomata_outputs ball_berry_gs(
     double leaf_temperature,        // degrees C
     double ambient_air_temperature  // degrees C
 )
+{
+    return ball_berry_gs_swvp(
+        assimilation,
+        ambient_c,
+        ambient_rh,
+        bb_offset,
+        bb_slope,
+        gbw,
+        ball_berry_swvp_ratio(leaf_temperature, ambient_air_temperature));
+}
+
+/**
+ *  @brief Calculates the ratio of saturation water vapor pressures at the
+ *  ambient air and leaf temperatures that appears in Equation (3) of
+ *  `ball_berry_gs()`.
+ *
+ *  This ratio only depends on temperature, so callers that evaluate the
+ *  Ball-Berry model many times at a fixed leaf temperature can calculate it
+ *  once and pass it to `ball_berry_gs_swvp()`.
+ */
+double ball_berry_swvp_ratio(
+    double leaf_temperature,        // degrees C
+    double ambient_air_temperature  // degrees C
+)
+{
+    return saturation_vapor_pressure(ambient_air_temperature) /
+           saturation_vapor_pressure(leaf_temperature);  // dimensionless
+}
+
+/**
+ *  @brief Equivalent to `ball_berry_gs()`, except that the saturation water
+ *  vapor pressure ratio is supplied directly rather than being calculated from
+ *  the leaf and air temperatures; see `ball_berry_swvp_ratio()`.
+ */
+stomata_outputs ball_berry_gs_swvp(
+    double assimilation,  // mol / m^2 / s
+    double ambient_c,     // mol / mol
+    double ambient_rh,    // Pa / Pa
+    double bb_offset,     // mol / m^2 / s
+    double bb_slope,      // dimensionless from [mol / m^2 / s] / [mol / m^2 / s]
+    double gbw,           // mol / m^2 / s
+    double swvp_ratio     // dimensionless
+)
 {
     // If An < 0, set b1 = 0 to ensure that gsw = b0 in Equation (1) as defined
     // above
@@ -122,10 +165,6 @@ stomata_outputs ball_berry_gs(
     // Calculate some variables that will be used in later equations
     const double acs = assimilation / Cs;  // mol / m^2 / s
 
-    const double swvp_ratio =
-        saturation_vapor_pressure(ambient_air_temperature) /
-        saturation_vapor_pressure(leaf_temperature);  // dimensionless
-
     // Calculate hs using Equation (3) as defined above
     const double a = bb_slope * acs;                              // mol / m^2 / s
     const double b = bb_offset + gbw - a;                         // mol / m^2 / s
@@ -13,4 +13,17 @@ stomata_outputs ball_berry_gs(
     double leaf_temperature,
     double ambient_air_temperature);
 
+stomata_outputs ball_berry_gs_swvp(
+    double assimilation,
+    double ambient_c,
+    double ambient_rh,
+    double bb_offset,
+    double bb_slope,
+    double gbw,
+    double swvp_ratio);
+
+double ball_berry_swvp_ratio(
+    double leaf_temperature,
+    double ambient_air_temperature);
+
 #endif
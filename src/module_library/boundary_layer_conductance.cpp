@@ -1,6 +1,7 @@
 #include <cmath>                       // for std::max, std::min, pow, log
 #include "../framework/constants.h"    // for celsius_to_kelvin
 #include "water_and_air_properties.h"  // for saturation_vapor_pressure
+#include "leaf_solver_statistics.h"    // for record_leaf_solver_call
 #include "boundary_layer_conductance.h"
 
 /**
@@ -108,6 +109,10 @@ double leaf_boundary_layer_conductance_nikolov(
 
     } while ((++counter <= 12) && (change_in_gbv > 0.01));
 
+    record_leaf_solver_call(
+        leaf_solver::leaf_boundary_layer_conductance_nikolov, counter,
+        change_in_gbv <= 0.01);
+
     // The overall conductance is the larger one
     return std::max(gbv_forced, gbv_free);  // m / s
 }
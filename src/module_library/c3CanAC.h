@@ -3,6 +3,8 @@
 
 #include "canopy_photosynthesis_outputs.h"  // for canopy_photosynthesis_outputs
 #include "c3_temperature_response.h"        // for c3_temperature_response_parameters
+#include "sunML.h"                          // for sunML_cache
+#include "scratch_arena.h"                  // for scratch_arena
 
 canopy_photosynthesis_outputs c3CanAC(
     c3_temperature_response_parameters const tr_param,
@@ -47,7 +49,8 @@ canopy_photosynthesis_outputs c3CanAC(
     double WindSpeed,            // m / s
     double WindSpeedHeight,      // m
     int lnfun,                   // dimensionless switch
-    int nlayers                  // dimensionless
-);
+    int nlayers,                 // dimensionless
+    sunML_cache& light_cache,
+    scratch_arena& scratch);
 
 #endif
@@ -5,6 +5,7 @@
 #include "../framework/state_map.h"
 #include "c3_temperature_response.h"  // for c3_temperature_response_parameters
 #include "c3photo.h"
+#include "ci_solver.h"                // for ci_solver_method
 
 namespace standardBML
 {
@@ -70,9 +71,13 @@ class c3_assimilation : public direct_module
    public:
     c3_assimilation(
         state_map const& input_quantities,
-        state_map* output_quantities)
+        state_map* output_quantities,
+        ci_solver_method solver = ci_solver_method::fixed_point)
         : direct_module{},
 
+          // Store the method used to find Ci
+          solver{solver},
+
           // Get pointers to input quantities
           atmospheric_pressure{get_input(input_quantities, "atmospheric_pressure")},
           b0{get_input(input_quantities, "b0")},
@@ -133,6 +138,9 @@ class c3_assimilation : public direct_module
     static std::string get_name() { return "c3_assimilation"; }
 
    private:
+    // Method used to find Ci
+    ci_solver_method const solver;
+
     // References to input quantities
     double const& atmospheric_pressure;
     double const& b0;
@@ -300,7 +308,8 @@ void c3_assimilation::do_operation() const
         electrons_per_carboxylation,
         electrons_per_oxygenation,
         beta_PSII,
-        gbw);
+        gbw,
+        solver);
 
     // Update the output quantity list
     update(Assim_op, c3_results.Assim);
@@ -314,5 +323,33 @@ void c3_assimilation::do_operation() const
     update(iterations_op, c3_results.iterations);
 }
 
+
+/**
+ * @class c3_assimilation_brent
+ *
+ * @brief Identical to `c3_assimilation`, except that the coupled equations are
+ * solved for Ci using Brent's method rather than fixed-point iteration; see
+ * `ci_solver_method` for more details.
+ *
+ * The ``'iterations'`` output is the number of times the residual function was
+ * evaluated, which can be compared to the number of fixed-point iterations
+ * reported by `c3_assimilation`. If a solution cannot be bracketed, `c3photoC()`
+ * falls back to the fixed-point iteration.
+ */
+class c3_assimilation_brent : public c3_assimilation
+{
+   public:
+    c3_assimilation_brent(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : c3_assimilation{
+              input_quantities,
+              output_quantities,
+              ci_solver_method::brent}
+    {
+    }
+    static std::string get_name() { return "c3_assimilation_brent"; }
+};
+
 }  // namespace standardBML
 #endif
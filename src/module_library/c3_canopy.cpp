@@ -156,7 +156,9 @@ void c3_canopy::do_operation() const
         windspeed,
         windspeed_height,
         lnfun,
-        nlayers);
+        nlayers,
+        light_cache,
+        scratch);
 
     // Update the output quantity list
     update(canopy_assimilation_rate_CO2_op, can_result.Assim);     // Mg / ha / hr
@@ -3,6 +3,8 @@
 
 #include "../framework/module.h"
 #include "../framework/state_map.h"
+#include "sunML.h"          // for sunML_cache
+#include "scratch_arena.h"  // for scratch_arena
 
 namespace standardBML
 {
@@ -166,6 +168,14 @@ class c3_canopy : public direct_module
     double* GrossAssim_CO2_op;
     double* canopy_photorespiration_rate_CO2_op;
 
+    // Light profile from the previous call, which is reused when its inputs
+    // have not changed
+    mutable sunML_cache light_cache;
+
+    // Memory for intermediate results, which is reused between calls to
+    // avoid repeated memory allocation
+    mutable scratch_arena scratch;
+
     // Main operation
     void do_operation() const;
 };
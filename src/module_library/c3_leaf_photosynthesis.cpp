@@ -2,8 +2,25 @@
 #include "c3photo.h"                  // for c3photoC
 #include "leaf_energy_balance.h"      // for leaf_energy_balance
 #include "c3_temperature_response.h"  // for c3_temperature_response_parameters
+#include "identical_values.h"         // for identical_values
 
 using standardBML::c3_leaf_photosynthesis;
+using standardBML::c3_leaf_photosynthesis_batch;
+using standardBML::c3_leaf_photosynthesis_coupled;
+
+namespace
+{
+// Determines whether all elements of a vector are identical
+bool is_uniform(std::vector<double> const& values)
+{
+    for (double const& v : values) {
+        if (!identical_values(v, values[0])) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
 
 string_vector c3_leaf_photosynthesis::get_inputs()
 {
@@ -75,6 +92,13 @@ string_vector c3_leaf_photosynthesis::get_outputs()
     };
 }
 
+string_vector c3_leaf_photosynthesis_coupled::get_outputs()
+{
+    string_vector outputs = c3_leaf_photosynthesis::get_outputs();
+    outputs.push_back("iterations");  // not a physical quantity
+    return outputs;
+}
+
 void c3_leaf_photosynthesis::do_operation() const
 {
     // Combine temperature response parameters
@@ -105,42 +129,41 @@ void c3_leaf_photosynthesis::do_operation() const
     // Make an initial guess for boundary layer conductance
     double const gbw_guess{1.2};  // mol / m^2 / s
 
-    // Get an initial estimate of stomatal conductance, assuming the leaf is at
-    // air temperature
-    double const initial_stomatal_conductance =
-        c3photoC(
-            tr_param, absorbed_ppfd, ambient_temperature, ambient_temperature,
-            rh, vmax1, jmax, tpu_rate_max, Rd, b0,
-            b1, Gs_min, Catm, atmospheric_pressure, O2, StomataWS,
-            electrons_per_carboxylation,
-            electrons_per_oxygenation, beta_PSII, gbw_guess)
-            .Gs;  // mol / m^2 / s
-
-    // Calculate a new value for leaf temperature using the estimate for
-    // stomatal conductance
-    const energy_balance_outputs et = leaf_energy_balance(
-        absorbed_longwave,
-        absorbed_shortwave,
-        atmospheric_pressure,
-        ambient_temperature,
-        gbw_canopy,
-        leafwidth,
-        rh,
-        initial_stomatal_conductance,
-        windspeed);
-
-    double const leaf_temperature = ambient_temperature + et.Deltat;  // degrees C
-
-    // Calculate final values for assimilation, stomatal conductance, and Ci
-    // using the new leaf temperature
-    const photosynthesis_outputs photo =
-        c3photoC(
+    // Calculate assimilation, stomatal conductance, and Ci at a given leaf
+    // temperature
+    auto photosynthesis = [this, &tr_param](
+                              double leaf_temperature,
+                              double gbw,
+                              ci_solver_method ci_solver,
+                              photosynthesis_outputs const* initial_guess) {
+        return c3photoC(
             tr_param, absorbed_ppfd, leaf_temperature, ambient_temperature,
             rh, vmax1, jmax,
             tpu_rate_max, Rd, b0, b1, Gs_min, Catm, atmospheric_pressure, O2,
             StomataWS,
             electrons_per_carboxylation, electrons_per_oxygenation, beta_PSII,
-            et.gbw_molecular);
+            gbw, ci_solver, initial_guess);
+    };
+
+    // Calculate the leaf temperature for a given stomatal conductance
+    auto energy_balance = [this](double stomatal_conductance) {
+        return leaf_energy_balance(
+            absorbed_longwave,
+            absorbed_shortwave,
+            atmospheric_pressure,
+            ambient_temperature,
+            gbw_canopy,
+            leafwidth,
+            rh,
+            stomatal_conductance,
+            windspeed);
+    };
+
+    coupled_leaf_outputs const leaf = solve_leaf_photosynthesis(
+        photosynthesis, energy_balance, ambient_temperature, gbw_guess, solver);
+
+    photosynthesis_outputs const& photo = leaf.photo;
+    energy_balance_outputs const& et = leaf.et;
 
     // Update the outputs
     update(Assim_op, photo.Assim);
@@ -151,9 +174,173 @@ void c3_leaf_photosynthesis::do_operation() const
     update(gbw_op, et.gbw_molecular);
     update(GrossAssim_op, photo.GrossAssim);
     update(Gs_op, photo.Gs);
-    update(leaf_temperature_op, leaf_temperature);
+    update(leaf_temperature_op, leaf.leaf_temperature);
     update(RHs_op, photo.RHs);
     update(RH_canopy_op, et.RH_canopy);
     update(Rp_op, photo.Rp);
     update(TransR_op, et.TransR);
+
+    if (solver == leaf_solver_method::coupled) {
+        update(iterations_op, leaf.iterations);
+    }
+}
+
+c3_temperature_response_parameters c3_leaf_photosynthesis_batch::tr_param(size_t i) const
+{
+    return c3_temperature_response_parameters{
+        Gstar_c[i],
+        Gstar_Ea[i],
+        Jmax_c[i],
+        Jmax_Ea[i],
+        Kc_c[i],
+        Kc_Ea[i],
+        Ko_c[i],
+        Ko_Ea[i],
+        phi_PSII_0[i],
+        phi_PSII_1[i],
+        phi_PSII_2[i],
+        Rd_c[i],
+        Rd_Ea[i],
+        theta_0[i],
+        theta_1[i],
+        theta_2[i],
+        Tp_c[i],
+        Tp_Ha[i],
+        Tp_Hd[i],
+        Tp_S[i],
+        Vcmax_c[i],
+        Vcmax_Ea[i]};
+}
+
+void c3_leaf_photosynthesis_batch::do_operation() const
+{
+    size_t const n = absorbed_ppfd.size();
+
+    scratch_arena::frame const frame(scratch);
+
+    // Make an initial guess for boundary layer conductance
+    double const gbw_guess{1.2};  // mol / m^2 / s
+
+    // `c3photoC_batch()` requires all leaves to share the same temperature
+    // response parameters. This is always true for leaves in a multilayer
+    // canopy, but it is checked here in case this batch is used differently.
+    bool const shared_tr_param =
+        is_uniform(Gstar_c) &&
+        is_uniform(Gstar_Ea) &&
+        is_uniform(Jmax_c) &&
+        is_uniform(Jmax_Ea) &&
+        is_uniform(Kc_c) &&
+        is_uniform(Kc_Ea) &&
+        is_uniform(Ko_c) &&
+        is_uniform(Ko_Ea) &&
+        is_uniform(phi_PSII_0) &&
+        is_uniform(phi_PSII_1) &&
+        is_uniform(phi_PSII_2) &&
+        is_uniform(Rd_c) &&
+        is_uniform(Rd_Ea) &&
+        is_uniform(theta_0) &&
+        is_uniform(theta_1) &&
+        is_uniform(theta_2) &&
+        is_uniform(Tp_c) &&
+        is_uniform(Tp_Ha) &&
+        is_uniform(Tp_Hd) &&
+        is_uniform(Tp_S) &&
+        is_uniform(Vcmax_c) &&
+        is_uniform(Vcmax_Ea);
+
+    c3photo_batch_inputs photo_inputs;
+    photo_inputs.allocate(scratch, n);
+
+    if (n > 0) {
+        photo_inputs.tr_param = tr_param(0);
+    }
+
+    auto photo = scratch.allocate<photosynthesis_outputs>(n);
+
+    // Calculate assimilation, stomatal conductance, and Ci for all leaves
+    auto photosynthesis = [this, shared_tr_param, n, &photo_inputs, photo]() {
+        if (shared_tr_param) {
+            c3photoC_batch(photo_inputs, photo, scratch);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                photo[i] = c3photoC(
+                    tr_param(i), photo_inputs.absorbed_ppfd[i],
+                    photo_inputs.Tleaf[i], photo_inputs.Tambient[i],
+                    photo_inputs.RH[i], photo_inputs.Vcmax0[i],
+                    photo_inputs.Jmax0[i], photo_inputs.TPU_rate_max[i],
+                    photo_inputs.Rd0[i], photo_inputs.bb0[i], photo_inputs.bb1[i],
+                    photo_inputs.Gs_min[i], photo_inputs.Ca[i], photo_inputs.AP[i],
+                    photo_inputs.O2[i], photo_inputs.StomWS[i],
+                    photo_inputs.electrons_per_carboxylation[i],
+                    photo_inputs.electrons_per_oxygenation[i],
+                    photo_inputs.beta_PSII[i], photo_inputs.gbw[i]);
+            }
+        }
+    };
+
+    // Get an initial estimate of stomatal conductance for each leaf, assuming
+    // the leaves are at air temperature
+    for (size_t i = 0; i < n; ++i) {
+        photo_inputs.absorbed_ppfd[i] = absorbed_ppfd[i];
+        photo_inputs.Tleaf[i] = ambient_temperature[i];
+        photo_inputs.Tambient[i] = ambient_temperature[i];
+        photo_inputs.RH[i] = rh[i];
+        photo_inputs.Vcmax0[i] = vmax1[i];
+        photo_inputs.Jmax0[i] = jmax[i];
+        photo_inputs.TPU_rate_max[i] = tpu_rate_max[i];
+        photo_inputs.Rd0[i] = Rd[i];
+        photo_inputs.bb0[i] = b0[i];
+        photo_inputs.bb1[i] = b1[i];
+        photo_inputs.Gs_min[i] = Gs_min[i];
+        photo_inputs.Ca[i] = Catm[i];
+        photo_inputs.AP[i] = atmospheric_pressure[i];
+        photo_inputs.O2[i] = O2[i];
+        photo_inputs.StomWS[i] = StomataWS[i];
+        photo_inputs.electrons_per_carboxylation[i] = electrons_per_carboxylation[i];
+        photo_inputs.electrons_per_oxygenation[i] = electrons_per_oxygenation[i];
+        photo_inputs.beta_PSII[i] = beta_PSII[i];
+        photo_inputs.gbw[i] = gbw_guess;
+    }
+
+    photosynthesis();
+
+    // Calculate new values for leaf temperature and boundary layer
+    // conductance
+    auto et = scratch.allocate<energy_balance_outputs>(n);
+    for (size_t i = 0; i < n; ++i) {
+        et[i] = leaf_energy_balance(
+            absorbed_longwave[i],
+            absorbed_shortwave[i],
+            atmospheric_pressure[i],
+            ambient_temperature[i],
+            gbw_canopy[i],
+            leafwidth[i],
+            rh[i],
+            photo[i].Gs,
+            windspeed[i]);
+
+        photo_inputs.Tleaf[i] = ambient_temperature[i] + et[i].Deltat;  // degrees C
+        photo_inputs.gbw[i] = et[i].gbw_molecular;                      // mol / m^2 / s
+    }
+
+    // Calculate final values for assimilation, stomatal conductance, and Ci
+    // using the new leaf temperatures
+    photosynthesis();
+
+    // Update the outputs
+    for (size_t i = 0; i < n; ++i) {
+        (*Assim_op)[i] = photo[i].Assim;
+        (*Ci_op)[i] = photo[i].Ci;
+        (*Cs_op)[i] = photo[i].Cs;
+        (*EPenman_op)[i] = et[i].EPenman;
+        (*EPriestly_op)[i] = et[i].EPriestly;
+        (*gbw_op)[i] = et[i].gbw_molecular;
+        (*GrossAssim_op)[i] = photo[i].GrossAssim;
+        (*Gs_op)[i] = photo[i].Gs;
+        (*leaf_temperature_op)[i] = photo_inputs.Tleaf[i];
+        (*RHs_op)[i] = photo[i].RHs;
+        (*RH_canopy_op)[i] = et[i].RH_canopy;
+        (*Rp_op)[i] = photo[i].Rp;
+        (*TransR_op)[i] = et[i].TransR;
+    }
 }
@@ -1,11 +1,177 @@
 #ifndef C3_LEAF_PHOTOSYNTHESIS_H
 #define C3_LEAF_PHOTOSYNTHESIS_H
 
+#include <cstddef>  // for size_t
+#include <vector>
 #include "../framework/state_map.h"
 #include "../framework/module.h"
+#include "coupled_leaf_solver.h"      // for leaf_solver_method
+#include "c3photo.h"                  // for c3photo_batch_inputs
+#include "c3_temperature_response.h"  // for c3_temperature_response_parameters
+#include "leaf_energy_balance.h"      // for energy_balance_outputs
+#include "leaf_batch.h"               // for leaf_batch
+#include "scratch_arena.h"            // for scratch_arena
 
 namespace standardBML
 {
+class c3_leaf_photosynthesis;
+
+/**
+ * @class c3_leaf_photosynthesis_batch
+ *
+ * @brief The batched version of `c3_leaf_photosynthesis`; see `leaf_batch` for
+ * more details. Photosynthesis is calculated for all leaves at once using
+ * `c3photoC_batch()`, unless the temperature response parameters differ between
+ * leaves; in that case, `c3photoC()` is called for each leaf.
+ */
+class c3_leaf_photosynthesis_batch : public leaf_batch
+{
+   public:
+    using module_type = c3_leaf_photosynthesis;
+
+    c3_leaf_photosynthesis_batch(
+        state_vector_map const& input_quantities,
+        state_vector_map* output_quantities)
+        : leaf_batch{},
+
+          // Get references to input quantity vectors
+          absorbed_longwave{get_batch_input(input_quantities, "absorbed_longwave")},
+          absorbed_ppfd{get_batch_input(input_quantities, "absorbed_ppfd")},
+          absorbed_shortwave{get_batch_input(input_quantities, "absorbed_shortwave")},
+          ambient_temperature{get_batch_input(input_quantities, "temp")},
+          atmospheric_pressure{get_batch_input(input_quantities, "atmospheric_pressure")},
+          b0{get_batch_input(input_quantities, "b0")},
+          b1{get_batch_input(input_quantities, "b1")},
+          beta_PSII{get_batch_input(input_quantities, "beta_PSII")},
+          Catm{get_batch_input(input_quantities, "Catm")},
+          electrons_per_carboxylation{get_batch_input(input_quantities, "electrons_per_carboxylation")},
+          electrons_per_oxygenation{get_batch_input(input_quantities, "electrons_per_oxygenation")},
+          gbw_canopy{get_batch_input(input_quantities, "gbw_canopy")},
+          Gs_min{get_batch_input(input_quantities, "Gs_min")},
+          Gstar_c{get_batch_input(input_quantities, "Gstar_c")},
+          Gstar_Ea{get_batch_input(input_quantities, "Gstar_Ea")},
+          height{get_batch_input(input_quantities, "height")},
+          jmax{get_batch_input(input_quantities, "jmax")},
+          Jmax_c{get_batch_input(input_quantities, "Jmax_c")},
+          Jmax_Ea{get_batch_input(input_quantities, "Jmax_Ea")},
+          Kc_c{get_batch_input(input_quantities, "Kc_c")},
+          Kc_Ea{get_batch_input(input_quantities, "Kc_Ea")},
+          Ko_c{get_batch_input(input_quantities, "Ko_c")},
+          Ko_Ea{get_batch_input(input_quantities, "Ko_Ea")},
+          leafwidth{get_batch_input(input_quantities, "leafwidth")},
+          O2{get_batch_input(input_quantities, "O2")},
+          phi_PSII_0{get_batch_input(input_quantities, "phi_PSII_0")},
+          phi_PSII_1{get_batch_input(input_quantities, "phi_PSII_1")},
+          phi_PSII_2{get_batch_input(input_quantities, "phi_PSII_2")},
+          Rd{get_batch_input(input_quantities, "Rd")},
+          Rd_c{get_batch_input(input_quantities, "Rd_c")},
+          Rd_Ea{get_batch_input(input_quantities, "Rd_Ea")},
+          rh{get_batch_input(input_quantities, "rh")},
+          StomataWS{get_batch_input(input_quantities, "StomataWS")},
+          theta_0{get_batch_input(input_quantities, "theta_0")},
+          theta_1{get_batch_input(input_quantities, "theta_1")},
+          theta_2{get_batch_input(input_quantities, "theta_2")},
+          Tp_c{get_batch_input(input_quantities, "Tp_c")},
+          Tp_Ha{get_batch_input(input_quantities, "Tp_Ha")},
+          Tp_Hd{get_batch_input(input_quantities, "Tp_Hd")},
+          Tp_S{get_batch_input(input_quantities, "Tp_S")},
+          tpu_rate_max{get_batch_input(input_quantities, "tpu_rate_max")},
+          Vcmax_c{get_batch_input(input_quantities, "Vcmax_c")},
+          Vcmax_Ea{get_batch_input(input_quantities, "Vcmax_Ea")},
+          vmax1{get_batch_input(input_quantities, "vmax1")},
+          windspeed{get_batch_input(input_quantities, "windspeed")},
+
+          // Get pointers to output quantity vectors
+          Assim_op{get_batch_op(output_quantities, "Assim")},
+          Ci_op{get_batch_op(output_quantities, "Ci")},
+          Cs_op{get_batch_op(output_quantities, "Cs")},
+          EPenman_op{get_batch_op(output_quantities, "EPenman")},
+          EPriestly_op{get_batch_op(output_quantities, "EPriestly")},
+          gbw_op{get_batch_op(output_quantities, "gbw")},
+          GrossAssim_op{get_batch_op(output_quantities, "GrossAssim")},
+          Gs_op{get_batch_op(output_quantities, "Gs")},
+          leaf_temperature_op{get_batch_op(output_quantities, "leaf_temperature")},
+          RHs_op{get_batch_op(output_quantities, "RHs")},
+          RH_canopy_op{get_batch_op(output_quantities, "RH_canopy")},
+          Rp_op{get_batch_op(output_quantities, "Rp")},
+          TransR_op{get_batch_op(output_quantities, "TransR")}
+    {
+    }
+
+   private:
+    // References to input quantity vectors
+    std::vector<double> const& absorbed_longwave;
+    std::vector<double> const& absorbed_ppfd;
+    std::vector<double> const& absorbed_shortwave;
+    std::vector<double> const& ambient_temperature;
+    std::vector<double> const& atmospheric_pressure;
+    std::vector<double> const& b0;
+    std::vector<double> const& b1;
+    std::vector<double> const& beta_PSII;
+    std::vector<double> const& Catm;
+    std::vector<double> const& electrons_per_carboxylation;
+    std::vector<double> const& electrons_per_oxygenation;
+    std::vector<double> const& gbw_canopy;
+    std::vector<double> const& Gs_min;
+    std::vector<double> const& Gstar_c;
+    std::vector<double> const& Gstar_Ea;
+    std::vector<double> const& height;
+    std::vector<double> const& jmax;
+    std::vector<double> const& Jmax_c;
+    std::vector<double> const& Jmax_Ea;
+    std::vector<double> const& Kc_c;
+    std::vector<double> const& Kc_Ea;
+    std::vector<double> const& Ko_c;
+    std::vector<double> const& Ko_Ea;
+    std::vector<double> const& leafwidth;
+    std::vector<double> const& O2;
+    std::vector<double> const& phi_PSII_0;
+    std::vector<double> const& phi_PSII_1;
+    std::vector<double> const& phi_PSII_2;
+    std::vector<double> const& Rd;
+    std::vector<double> const& Rd_c;
+    std::vector<double> const& Rd_Ea;
+    std::vector<double> const& rh;
+    std::vector<double> const& StomataWS;
+    std::vector<double> const& theta_0;
+    std::vector<double> const& theta_1;
+    std::vector<double> const& theta_2;
+    std::vector<double> const& Tp_c;
+    std::vector<double> const& Tp_Ha;
+    std::vector<double> const& Tp_Hd;
+    std::vector<double> const& Tp_S;
+    std::vector<double> const& tpu_rate_max;
+    std::vector<double> const& Vcmax_c;
+    std::vector<double> const& Vcmax_Ea;
+    std::vector<double> const& vmax1;
+    std::vector<double> const& windspeed;
+
+    // Pointers to output quantity vectors
+    std::vector<double>* Assim_op;
+    std::vector<double>* Ci_op;
+    std::vector<double>* Cs_op;
+    std::vector<double>* EPenman_op;
+    std::vector<double>* EPriestly_op;
+    std::vector<double>* gbw_op;
+    std::vector<double>* GrossAssim_op;
+    std::vector<double>* Gs_op;
+    std::vector<double>* leaf_temperature_op;
+    std::vector<double>* RHs_op;
+    std::vector<double>* RH_canopy_op;
+    std::vector<double>* Rp_op;
+    std::vector<double>* TransR_op;
+
+    // Memory for intermediate results, which is reused between calls to
+    // avoid repeated memory allocation
+    mutable scratch_arena scratch;
+
+    // Temperature response parameters for one leaf
+    c3_temperature_response_parameters tr_param(size_t i) const;
+
+    // Main operation
+    void do_operation() const;
+};
+
 /**
  * @class c3_leaf_photosynthesis
  *
@@ -17,9 +183,13 @@ class c3_leaf_photosynthesis : public direct_module
    public:
     c3_leaf_photosynthesis(
         state_map const& input_quantities,
-        state_map* output_quantities)
+        state_map* output_quantities,
+        leaf_solver_method solver = leaf_solver_method::two_pass)
         : direct_module{},
 
+          // Store the method used to find the leaf temperature
+          solver{solver},
+
           // Get references to input quantities
           absorbed_longwave{get_input(input_quantities, "absorbed_longwave")},
           absorbed_ppfd{get_input(input_quantities, "absorbed_ppfd")},
@@ -80,14 +250,24 @@ class c3_leaf_photosynthesis : public direct_module
           RHs_op{get_op(output_quantities, "RHs")},
           RH_canopy_op{get_op(output_quantities, "RH_canopy")},
           Rp_op{get_op(output_quantities, "Rp")},
-          TransR_op{get_op(output_quantities, "TransR")}
+          TransR_op{get_op(output_quantities, "TransR")},
+          iterations_op{
+              solver == leaf_solver_method::coupled
+                  ? get_op(output_quantities, "iterations")
+                  : nullptr}
     {
     }
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "c3_leaf_photosynthesis"; }
 
+    // Batched version of this module
+    using batch_type = c3_leaf_photosynthesis_batch;
+
    private:
+    // Method used to find the leaf temperature
+    leaf_solver_method const solver;
+
     // References to input quantities
     double const& absorbed_longwave;
     double const& absorbed_ppfd;
@@ -149,10 +329,37 @@ class c3_leaf_photosynthesis : public direct_module
     double* RH_canopy_op;
     double* Rp_op;
     double* TransR_op;
+    double* iterations_op;  // only used with the coupled solver
 
     // Main operation
     void do_operation() const;
 };
 
+/**
+ * @class c3_leaf_photosynthesis_coupled
+ *
+ * @brief Identical to `c3_leaf_photosynthesis`, except that the photosynthesis and
+ * energy balance calculations are iterated until the leaf temperature
+ * converges; see `leaf_solver_method` for more details.
+ *
+ * This module has one additional output: ``'iterations'``, the total number of
+ * photosynthesis iterations used by all of the photosynthesis calculations.
+ */
+class c3_leaf_photosynthesis_coupled : public c3_leaf_photosynthesis
+{
+   public:
+    c3_leaf_photosynthesis_coupled(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : c3_leaf_photosynthesis{
+              input_quantities,
+              output_quantities,
+              leaf_solver_method::coupled}
+    {
+    }
+    static string_vector get_outputs();
+    static std::string get_name() { return "c3_leaf_photosynthesis_coupled"; }
+};
+
 }  // namespace standardBML
 #endif
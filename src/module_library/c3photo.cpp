@@ -1,8 +1,11 @@
 #include <cmath>                             // for pow, sqrt, std::abs
 #include <algorithm>                         // for std::min
-#include "ball_berry_gs.h"                   // for ball_berry_gs
+#include <vector>
+#include "ball_berry_gs.h"                   // for ball_berry_gs, ball_berry_gs_swvp, ball_berry_swvp_ratio
 #include "FvCB_assim.h"                      // for FvCB_assim
 #include "conductance_limited_assim.h"       // for conductance_limited_assim
+#include "ci_solver.h"                       // for ci_solver_method, solve_ci_brent
+#include "leaf_solver_statistics.h"          // for record_leaf_solver_call, leaf_solver
 #include "c3_temperature_response.h"         // for c3_temperature_response
 #include "../framework/constants.h"          // for dr_stomata, dr_boundary
 #include "c3photo.h"
@@ -10,32 +13,43 @@
 using physical_constants::dr_boundary;
 using physical_constants::dr_stomata;
 
-photosynthesis_outputs c3photoC(
-    c3_temperature_response_parameters const tr_param,
-    double const absorbed_ppfd,                // micromol / m^2 / s
-    double const Tleaf,                        // degrees C
-    double const Tambient,                     // degrees C
-    double const RH,                           // dimensionless
-    double const Vcmax0,                       // micromol / m^2 / s
-    double const Jmax0,                        // micromol / m^2 / s
-    double const TPU_rate_max,                 // micromol / m^2 / s
-    double const Rd0,                          // micromol / m^2 / s
-    double const b0,                           // mol / m^2 / s
-    double const b1,                           // dimensionless
-    double const Gs_min,                       // mol / m^2 / s
-    double const Ca,                           // micromol / mol
-    double const AP,                           // Pa (TEMPORARILY UNUSED)
-    double const O2,                           // millimol / mol (atmospheric oxygen mole fraction)
-    double const StomWS,                       // dimensionless
-    double const electrons_per_carboxylation,  // self-explanatory units
-    double const electrons_per_oxygenation,    // self-explanatory units
-    double const beta_PSII,                    // dimensionless (fraction of absorbed light that reaches photosystem II)
-    double const gbw                           // mol / m^2 / s
-)
+namespace
 {
-    // Calculate values of key parameters at leaf temperature
-    c3_param_at_tleaf c3_param = c3_temperature_response(tr_param, Tleaf);
+/**
+ * @brief Quantities used by `c3photoC()` that depend on the leaf temperature
+ * and other inputs, but not on the intercellular CO2 concentration, so they
+ * only need to be calculated once per leaf.
+ */
+struct c3_leaf_constants {
+    double Gstar;      // micromol / mol
+    double J;          // micromol / m^2 / s
+    double Kc;         // micromol / mol
+    double Ko;         // mmol / mol
+    double Oi;         // mmol / mol
+    double Rd;         // micromol / m^2 / s
+    double TPU;        // micromol / m^2 / s
+    double Vcmax;      // micromol / m^2 / s
+    double alpha_TPU;  // dimensionless
+    double b0_adj;     // mol / m^2 / s
+    double b1_adj;     // dimensionless
+};
 
+c3_leaf_constants get_c3_leaf_constants(
+    c3_param_at_tleaf const& c3_param,
+    double const absorbed_ppfd,  // micromol / m^2 / s
+    double const Tleaf,          // degrees C
+    double const Vcmax0,         // micromol / m^2 / s
+    double const Jmax0,          // micromol / m^2 / s
+    double const TPU_rate_max,   // micromol / m^2 / s
+    double const Rd0,            // micromol / m^2 / s
+    double const b0,             // mol / m^2 / s
+    double const b1,             // dimensionless
+    double const Gs_min,         // mol / m^2 / s
+    double const O2,             // millimol / mol (atmospheric oxygen mole fraction)
+    double const StomWS,         // dimensionless
+    double const beta_PSII       // dimensionless (fraction of absorbed light that reaches photosystem II)
+)
+{
     double const dark_adapted_phi_PSII = c3_param.phi_PSII;  // dimensionless
     double const Gstar = c3_param.Gstar;                     // micromol / mol
     double const Jmax = Jmax0 * c3_param.Jmax_norm;          // micromol / m^2 / s
@@ -73,6 +87,242 @@ photosynthesis_outputs c3photoC(
     double const b0_adj = StomWS * b0 + Gs_min * (1.0 - StomWS);
     double const b1_adj = StomWS * b1;
 
+    return c3_leaf_constants{
+        Gstar, J, Kc, Ko, Oi, Rd, TPU, Vcmax, alpha_TPU, b0_adj, b1_adj};
+}
+
+int constexpr c3_max_iterations = 1000;
+double constexpr c3_tolerance = 0.01;  // micromol / m^2 / s
+
+/**
+ * @brief Calculates the `c3photoC()` outputs for a leaf that receives no light.
+ *
+ * Without light, the electron transport rate is zero, so there is no
+ * carboxylation for any Ci and the fixed point loop in `c3photoC()` finds a net
+ * assimilation rate of `-Rd` on its first pass, along with the Ball-Berry
+ * stomatal conductance for that rate. The loop stops there if `-Rd` is within
+ * the tolerance of the starting assimilation rate; otherwise, it makes a second
+ * pass that reproduces the same values and then stops. Here the outputs of
+ * those passes are calculated directly, including the conductance-limited
+ * assimilation rate, which uses the stomatal conductance from the start of the
+ * last pass, and the number of iterations, which is the number of passes minus
+ * one.
+ *
+ * This assumes that respiration is not negative, so that the conductance limit
+ * never applies.
+ */
+photosynthesis_outputs c3photoC_dark(
+    c3_leaf_constants const& lc,
+    double const swvp_ratio,     // dimensionless
+    double const RH,             // dimensionless
+    double const Ca,             // micromol / mol
+    double const gbw,            // mol / m^2 / s
+    double const initial_Assim,  // micromol / m^2 / s
+    double const initial_Gs      // mol / m^2 / s
+)
+{
+    double const co2_assimilation_rate = -lc.Rd;  // micromol / m^2 / s
+
+    stomata_outputs const BB_res = ball_berry_gs_swvp(
+        co2_assimilation_rate * 1e-6,
+        Ca * 1e-6,
+        RH,
+        lc.b0_adj,
+        lc.b1_adj,
+        gbw,
+        swvp_ratio);
+
+    double const Gs = BB_res.gsw;  // mol / m^2 / s
+
+    double const Ci = Ca - co2_assimilation_rate *
+                               (dr_boundary / gbw + dr_stomata / Gs);  // micromol / mol
+
+    int const iterations =
+        std::abs(initial_Assim - co2_assimilation_rate) < c3_tolerance ? 0 : 1;
+
+    double const an_conductance = conductance_limited_assim(
+        Ca, gbw, iterations == 0 ? initial_Gs : Gs);  // micromol / m^2 / s
+
+    return photosynthesis_outputs{
+        /* .Assim = */ co2_assimilation_rate,       // micromol / m^2 / s
+        /* .Assim_conductance = */ an_conductance,  // micromol / m^2 / s
+        /* .Ci = */ Ci,                             // micromol / mol
+        /* .GrossAssim = */ 0,                      // micromol / m^2 / s
+        /* .Gs = */ Gs,                             // mol / m^2 / s
+        /* .Cs = */ BB_res.cs,                      // micromol / m^2 / s
+        /* .RHs = */ BB_res.hs,                     // dimensionless from Pa / Pa
+        /* .Rp = */ 0,                              // micromol / m^2 / s
+        /* .iterations = */ iterations              // not a physical quantity
+    };
+}
+
+/**
+ * @brief Solves the coupled assimilation and stomatal conductance equations for
+ * a C3 leaf using `solve_ci_brent()`.
+ *
+ * As in the fixed point loop of `c3photoC()`, the net assimilation rate is
+ * limited by conductance so that Ci and the CO2 concentration at the leaf
+ * surface can never become negative. Here the limit is calculated using the
+ * initial guess for the stomatal conductance from the fixed point loop, which
+ * keeps the residual function independent of the solver history; the limit
+ * always exceeds the assimilation rate at the solution, so it does not change
+ * the result.
+ *
+ * @return `true` if a solution was found and stored in `result`.
+ */
+bool c3photoC_brent(
+    c3_leaf_constants const& lc,
+    double const Tleaf,                        // degrees C
+    double const Tambient,                     // degrees C
+    double const RH,                           // dimensionless
+    double const Ca,                           // micromol / mol
+    double const electrons_per_carboxylation,  // self-explanatory units
+    double const electrons_per_oxygenation,    // self-explanatory units
+    double const gbw,                          // mol / m^2 / s
+    double const* Ci_guess,                    // micromol / mol (optional)
+    photosynthesis_outputs& result)
+{
+    double const an_max =
+        conductance_limited_assim(Ca, gbw, 1e3);  // micromol / m^2 / s
+
+    FvCB_outputs FvCB_res;
+    stomata_outputs BB_res;
+    double co2_assimilation_rate{};  // micromol / m^2 / s
+    double Gs{};                     // mol / m^2 / s
+    double Ci_new{};                 // micromol / mol
+
+    auto residual = [&](double Ci) {
+        FvCB_res = FvCB_assim(
+            Ci,
+            lc.Gstar,
+            lc.J,
+            lc.Kc,
+            lc.Ko,
+            lc.Oi,
+            lc.Rd,
+            lc.TPU,
+            lc.Vcmax,
+            lc.alpha_TPU,
+            electrons_per_carboxylation,
+            electrons_per_oxygenation);
+
+        co2_assimilation_rate = std::min(FvCB_res.An, an_max);  // micromol / m^2 / s
+
+        BB_res = ball_berry_gs(
+            co2_assimilation_rate * 1e-6,
+            Ca * 1e-6,
+            RH,
+            lc.b0_adj,
+            lc.b1_adj,
+            gbw,
+            Tleaf,
+            Tambient);
+
+        Gs = BB_res.gsw;  // mol / m^2 / s
+
+        Ci_new = Ca - co2_assimilation_rate *
+                          (dr_boundary / gbw + dr_stomata / Gs);  // micromol / mol
+
+        return Ci_new - Ci;  // micromol / mol
+    };
+
+    double Ci{};  // micromol / mol
+    int evaluations{0};
+    bool const found = solve_ci_brent(residual, Ca, Ci, evaluations, Ci_guess);
+
+    record_leaf_solver_call(leaf_solver::c3photoC_brent, evaluations, found);
+
+    if (!found) {
+        return false;
+    }
+
+    // Make sure the stored state corresponds to the solution
+    residual(Ci);
+
+    result = photosynthesis_outputs{
+        /* .Assim = */ co2_assimilation_rate,                               // micromol / m^2 / s
+        /* .Assim_conductance = */ conductance_limited_assim(Ca, gbw, Gs),  // micromol / m^2 / s
+        /* .Ci = */ Ci_new,                                                 // micromol / mol
+        /* .GrossAssim = */ FvCB_res.Vc,                                    // micromol / m^2 / s
+        /* .Gs = */ Gs,                                                     // mol / m^2 / s
+        /* .Cs = */ BB_res.cs,                                              // micromol / m^2 / s
+        /* .RHs = */ BB_res.hs,                                             // dimensionless from Pa / Pa
+        /* .Rp = */ FvCB_res.Vc * lc.Gstar / Ci_new,                        // micromol / m^2 / s
+        /* .iterations = */ evaluations                                     // not a physical quantity
+    };
+
+    return true;
+}
+
+}  // namespace
+
+photosynthesis_outputs c3photoC(
+    c3_temperature_response_parameters const tr_param,
+    double const absorbed_ppfd,                  // micromol / m^2 / s
+    double const Tleaf,                          // degrees C
+    double const Tambient,                       // degrees C
+    double const RH,                             // dimensionless
+    double const Vcmax0,                         // micromol / m^2 / s
+    double const Jmax0,                          // micromol / m^2 / s
+    double const TPU_rate_max,                   // micromol / m^2 / s
+    double const Rd0,                            // micromol / m^2 / s
+    double const b0,                             // mol / m^2 / s
+    double const b1,                             // dimensionless
+    double const Gs_min,                         // mol / m^2 / s
+    double const Ca,                             // micromol / mol
+    double const AP,                             // Pa (TEMPORARILY UNUSED)
+    double const O2,                             // millimol / mol (atmospheric oxygen mole fraction)
+    double const StomWS,                         // dimensionless
+    double const electrons_per_carboxylation,    // self-explanatory units
+    double const electrons_per_oxygenation,      // self-explanatory units
+    double const beta_PSII,                      // dimensionless (fraction of absorbed light that reaches photosystem II)
+    double const gbw,                            // mol / m^2 / s
+    ci_solver_method const solver,               // selects the method used to find Ci
+    photosynthesis_outputs const* initial_guess  // optional starting point for the fixed point loop
+)
+{
+    // Calculate values of key parameters at leaf temperature
+    c3_leaf_constants const lc = get_c3_leaf_constants(
+        c3_temperature_response(tr_param, Tleaf),
+        absorbed_ppfd, Tleaf, Vcmax0, Jmax0, TPU_rate_max, Rd0, b0, b1,
+        Gs_min, O2, StomWS, beta_PSII);
+
+    // Use Brent's method if requested, falling back to the fixed point loop if
+    // a solution cannot be bracketed
+    photosynthesis_outputs brent_result;
+    if (solver == ci_solver_method::brent &&
+        c3photoC_brent(
+            lc, Tleaf, Tambient, RH, Ca, electrons_per_carboxylation,
+            electrons_per_oxygenation, gbw,
+            initial_guess ? &initial_guess->Ci : nullptr, brent_result)) {
+        return brent_result;
+    }
+
+    // There is nothing to iterate over when the leaf receives no light
+    if (absorbed_ppfd == 0) {
+        photosynthesis_outputs const dark_result = c3photoC_dark(
+            lc, ball_berry_swvp_ratio(Tleaf, Tambient), RH, Ca, gbw,
+            initial_guess ? initial_guess->Assim : 0.0,
+            initial_guess ? initial_guess->Gs : 1e3);
+
+        record_leaf_solver_call(
+            leaf_solver::c3photoC, dark_result.iterations, true);
+
+        return dark_result;
+    }
+
+    double const Gstar = lc.Gstar;          // micromol / mol
+    double const J = lc.J;                  // micromol / m^2 / s
+    double const Kc = lc.Kc;                // micromol / mol
+    double const Ko = lc.Ko;                // mmol / mol
+    double const Oi = lc.Oi;                // mmol / mol
+    double const Rd = lc.Rd;                // micromol / m^2 / s
+    double const TPU = lc.TPU;              // micromol / m^2 / s
+    double const Vcmax = lc.Vcmax;          // micromol / m^2 / s
+    double const alpha_TPU = lc.alpha_TPU;  // dimensionless
+    double const b0_adj = lc.b0_adj;        // mol / m^2 / s
+    double const b1_adj = lc.b1_adj;        // dimensionless
+
     // Initialize variables before running fixed point iteration in a loop
     FvCB_outputs FvCB_res;
     stomata_outputs BB_res;
@@ -80,9 +330,17 @@ photosynthesis_outputs c3photoC(
     double Gs{1e3};                     // mol / m^2 / s      (initial guess)
     double Ci{0.0};                     // micromol / mol     (initial guess)
     double co2_assimilation_rate{0.0};  // micromol / m^2 / s (initial guess)
-    double const Tol{0.01};             // micromol / m^2 / s
+    double const Tol{c3_tolerance};     // micromol / m^2 / s
     int iterCounter{0};
-    int max_iter{1000};
+    int max_iter{c3_max_iterations};
+
+    // If a previous solution for similar conditions is available, start from
+    // it instead
+    if (initial_guess) {
+        Gs = initial_guess->Gs;                        // mol / m^2 / s
+        Ci = initial_guess->Ci;                        // micromol / mol
+        co2_assimilation_rate = initial_guess->Assim;  // micromol / m^2 / s
+    }
 
     // Run iteration loop
     while (iterCounter < max_iter) {
@@ -136,6 +394,9 @@ photosynthesis_outputs c3photoC(
         ++iterCounter;
     }
 
+    record_leaf_solver_call(
+        leaf_solver::c3photoC, iterCounter, iterCounter < max_iter);
+
     return photosynthesis_outputs{
         /* .Assim = */ co2_assimilation_rate,       // micromol / m^2 / s
         /* .Assim_conductance = */ an_conductance,  // micromol / m^2 / s
@@ -149,6 +410,182 @@ photosynthesis_outputs c3photoC(
     };
 }
 
+void c3photo_batch_inputs::allocate(scratch_arena& scratch, size_t n)
+{
+    for (scratch_span<double>* v :
+         {&absorbed_ppfd, &Tleaf, &Tambient, &RH, &Vcmax0, &Jmax0,
+          &TPU_rate_max, &Rd0, &bb0, &bb1, &Gs_min, &Ca, &AP, &O2, &StomWS,
+          &electrons_per_carboxylation, &electrons_per_oxygenation, &beta_PSII,
+          &gbw}) {
+        *v = scratch.allocate<double>(n);
+    }
+}
+
+void c3photo_batch_inputs::truncate(size_t n)
+{
+    for (scratch_span<double>* v :
+         {&absorbed_ppfd, &Tleaf, &Tambient, &RH, &Vcmax0, &Jmax0,
+          &TPU_rate_max, &Rd0, &bb0, &bb1, &Gs_min, &Ca, &AP, &O2, &StomWS,
+          &electrons_per_carboxylation, &electrons_per_oxygenation, &beta_PSII,
+          &gbw}) {
+        v->truncate(n);
+    }
+}
+
+/**
+ * @brief Applies `c3photoC()` to a batch of leaves at once.
+ *
+ * The temperature responses and other quantities that do not change during
+ * the convergence loop are calculated once per leaf beforehand; when
+ * consecutive leaves have the same temperature, as is the case when all leaves
+ * are initially assumed to be at the air temperature, the temperature
+ * responses are only calculated once for the whole group. The leaves are then
+ * iterated in lockstep, with each pass of the loop updating every leaf that
+ * has not yet converged. A leaf is removed from the active set as soon as it
+ * meets the same stopping criteria used by `c3photoC()`, which acts as a
+ * per-leaf convergence mask. Leaves that receive no light never enter the
+ * loop.
+ *
+ * The loop itself is not vectorized: each pass reaches the active leaves
+ * through a list of indices and calls `FvCB_assim()` and
+ * `ball_berry_gs_swvp()`, which are defined in other translation units. The
+ * savings come from calculating the temperature responses less often and from
+ * skipping leaves that have already converged.
+ *
+ * Each leaf goes through exactly the same sequence of floating-point
+ * operations as in `c3photoC()`, so the outputs, including the number of
+ * iterations, are identical to calling `c3photoC()` separately for each leaf.
+ *
+ * The results are stored in `outputs`, which must have one element per leaf.
+ * Intermediate arrays are allocated from `scratch` and released before
+ * returning.
+ */
+void c3photoC_batch(
+    c3photo_batch_inputs const& inputs,
+    scratch_span<photosynthesis_outputs> outputs,
+    scratch_arena& scratch)
+{
+    size_t const n = inputs.size();
+
+    scratch_arena::frame const frame(scratch);
+
+    auto lc = scratch.allocate<c3_leaf_constants>(n);
+    auto swvp_ratio = scratch.allocate<double>(n);                  // dimensionless
+    auto an_conductance = scratch.allocate<double>(n);              // micromol / m^2 / s
+    auto Gs = scratch.allocate<double>(n, 1e3);                     // mol / m^2 / s
+    auto Ci = scratch.allocate<double>(n, 0.0);                     // micromol / mol
+    auto co2_assimilation_rate = scratch.allocate<double>(n, 0.0);  // micromol / m^2 / s
+    auto Vc = scratch.allocate<double>(n);                          // micromol / m^2 / s
+    auto BB_res = scratch.allocate<stomata_outputs>(n);
+    auto iterCounter = scratch.allocate<int>(n, 0);
+    auto active = scratch.allocate<size_t>(n);
+    size_t n_active = 0;
+
+    c3_param_at_tleaf c3_param{};
+    for (size_t i = 0; i < n; ++i) {
+        if (i == 0 || inputs.Tleaf[i] != inputs.Tleaf[i - 1]) {
+            c3_param = c3_temperature_response(inputs.tr_param, inputs.Tleaf[i]);
+        }
+
+        lc[i] = get_c3_leaf_constants(
+            c3_param, inputs.absorbed_ppfd[i], inputs.Tleaf[i],
+            inputs.Vcmax0[i], inputs.Jmax0[i], inputs.TPU_rate_max[i],
+            inputs.Rd0[i], inputs.bb0[i], inputs.bb1[i], inputs.Gs_min[i],
+            inputs.O2[i], inputs.StomWS[i], inputs.beta_PSII[i]);
+
+        swvp_ratio[i] = ball_berry_swvp_ratio(inputs.Tleaf[i], inputs.Tambient[i]);
+
+        if (inputs.absorbed_ppfd[i] == 0) {
+            outputs[i] = c3photoC_dark(
+                lc[i], swvp_ratio[i], inputs.RH[i], inputs.Ca[i], inputs.gbw[i],
+                co2_assimilation_rate[i], Gs[i]);
+
+            record_leaf_solver_call(
+                leaf_solver::c3photoC, outputs[i].iterations, true);
+        } else {
+            active[n_active++] = i;
+        }
+    }
+    active.truncate(n_active);
+
+    while (!active.empty()) {
+        n_active = 0;
+
+        for (size_t const i : active) {
+            double const OldAssim = co2_assimilation_rate[i];  // micromol / m^2 / s
+
+            an_conductance[i] = conductance_limited_assim(
+                inputs.Ca[i], inputs.gbw[i], Gs[i]);  // micromol / m^2 / s
+
+            FvCB_outputs const FvCB_res = FvCB_assim(
+                Ci[i],
+                lc[i].Gstar,
+                lc[i].J,
+                lc[i].Kc,
+                lc[i].Ko,
+                lc[i].Oi,
+                lc[i].Rd,
+                lc[i].TPU,
+                lc[i].Vcmax,
+                lc[i].alpha_TPU,
+                inputs.electrons_per_carboxylation[i],
+                inputs.electrons_per_oxygenation[i]);
+
+            Vc[i] = FvCB_res.Vc;
+
+            co2_assimilation_rate[i] =
+                std::min(FvCB_res.An, an_conductance[i]);  // micromol / m^2 / s
+
+            BB_res[i] = ball_berry_gs_swvp(
+                co2_assimilation_rate[i] * 1e-6,
+                inputs.Ca[i] * 1e-6,
+                inputs.RH[i],
+                lc[i].b0_adj,
+                lc[i].b1_adj,
+                inputs.gbw[i],
+                swvp_ratio[i]);
+
+            Gs[i] = BB_res[i].gsw;  // mol / m^2 / s
+
+            Ci[i] = inputs.Ca[i] -
+                    co2_assimilation_rate[i] *
+                        (dr_boundary / inputs.gbw[i] + dr_stomata / Gs[i]);  // micromol / mol
+
+            // Keep iterating this leaf only if it has not converged and has
+            // not reached the iteration limit
+            if (!(std::abs(OldAssim - co2_assimilation_rate[i]) < c3_tolerance) &&
+                ++iterCounter[i] < c3_max_iterations) {
+                active[n_active++] = i;
+            }
+        }
+
+        active.truncate(n_active);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        // Leaves without light were already handled above
+        if (inputs.absorbed_ppfd[i] == 0) {
+            continue;
+        }
+
+        record_leaf_solver_call(
+            leaf_solver::c3photoC, iterCounter[i],
+            iterCounter[i] < c3_max_iterations);
+
+        outputs[i] = photosynthesis_outputs{
+            /* .Assim = */ co2_assimilation_rate[i],       // micromol / m^2 / s
+            /* .Assim_conductance = */ an_conductance[i],  // micromol / m^2 / s
+            /* .Ci = */ Ci[i],                             // micromol / mol
+            /* .GrossAssim = */ Vc[i],                     // micromol / m^2 / s
+            /* .Gs = */ Gs[i],                             // mol / m^2 / s
+            /* .Cs = */ BB_res[i].cs,                      // micromol / m^2 / s
+            /* .RHs = */ BB_res[i].hs,                     // dimensionless from Pa / Pa
+            /* .Rp = */ Vc[i] * lc[i].Gstar / Ci[i],       // micromol / m^2 / s
+            /* .iterations = */ iterCounter[i]             // not a physical quantity
+        };
+    }
+}
+
 // This function returns the solubility of O2 in H2O relative to its value at
 // 25 degrees C. The equation used here was developed by forming a polynomial
 // fit to tabulated solubility values from a reference book, and then a
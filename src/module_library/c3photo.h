@@ -1,8 +1,11 @@
 #ifndef C3PHOTO_H
 #define C3PHOTO_H
 
+#include <cstddef>                    // for size_t
 #include "photosynthesis_outputs.h"   // for photosynthesis_outputs
 #include "c3_temperature_response.h"  // for c3_temperature_response_parameters
+#include "ci_solver.h"                // for ci_solver_method
+#include "scratch_arena.h"            // for scratch_arena, scratch_span
 
 photosynthesis_outputs c3photoC(
     c3_temperature_response_parameters const tr_param,
@@ -17,14 +20,54 @@ photosynthesis_outputs c3photoC(
     double const bb0,
     double const bb1,
     double const Gs_min,
-    double Ca,
+    double const Ca,
     double const AP,
     double const O2,
     double const StomWS,
     double const electrons_per_carboxylation,
     double const electrons_per_oxygenation,
     double const beta_PSII,
-    double const gbw);
+    double const gbw,
+    ci_solver_method const solver = ci_solver_method::fixed_point,
+    photosynthesis_outputs const* initial_guess = nullptr);
+
+/**
+ * @brief Inputs to `c3photoC_batch()` stored as a structure of arrays, where
+ * element `i` of each array holds the corresponding `c3photoC()` argument for
+ * leaf `i` of the batch. The arrays are allocated from a `scratch_arena`. The
+ * temperature response parameters are shared by all leaves in the batch.
+ */
+struct c3photo_batch_inputs {
+    c3_temperature_response_parameters tr_param;
+    scratch_span<double> absorbed_ppfd;
+    scratch_span<double> Tleaf;
+    scratch_span<double> Tambient;
+    scratch_span<double> RH;
+    scratch_span<double> Vcmax0;
+    scratch_span<double> Jmax0;
+    scratch_span<double> TPU_rate_max;
+    scratch_span<double> Rd0;
+    scratch_span<double> bb0;
+    scratch_span<double> bb1;
+    scratch_span<double> Gs_min;
+    scratch_span<double> Ca;
+    scratch_span<double> AP;
+    scratch_span<double> O2;
+    scratch_span<double> StomWS;
+    scratch_span<double> electrons_per_carboxylation;
+    scratch_span<double> electrons_per_oxygenation;
+    scratch_span<double> beta_PSII;
+    scratch_span<double> gbw;
+
+    void allocate(scratch_arena& scratch, size_t n);
+    void truncate(size_t n);
+    size_t size() const { return absorbed_ppfd.size(); }
+};
+
+void c3photoC_batch(
+    c3photo_batch_inputs const& inputs,
+    scratch_span<photosynthesis_outputs> outputs,
+    scratch_arena& scratch);
 
 double solc(double LeafT);
 double solo(double LeafT);
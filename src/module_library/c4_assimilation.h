@@ -4,6 +4,7 @@
 #include "../framework/module.h"
 #include "../framework/state_map.h"
 #include "c4photo.h"
+#include "ci_solver.h"  // for ci_solver_method
 
 namespace standardBML
 {
@@ -69,9 +70,13 @@ class c4_assimilation : public direct_module
    public:
     c4_assimilation(
         state_map const& input_quantities,
-        state_map* output_quantities)
+        state_map* output_quantities,
+        ci_solver_method solver = ci_solver_method::fixed_point)
         : direct_module{},
 
+          // Store the method used to find Ci
+          solver{solver},
+
           // Get pointers to input quantities
           Qp{get_input(input_quantities, "Qp")},
           Tleaf{get_input(input_quantities, "Tleaf")},
@@ -110,6 +115,9 @@ class c4_assimilation : public direct_module
     static std::string get_name() { return "c4_assimilation"; }
 
    private:
+    // Method used to find Ci
+    ci_solver_method const solver;
+
     // References to input quantities
     double const& Qp;
     double const& Tleaf;
@@ -207,7 +215,8 @@ void c4_assimilation::do_operation() const
         atmospheric_pressure,
         upperT,
         lowerT,
-        gbw);
+        gbw,
+        solver);
 
     // Update the output quantity list
     update(Assim_op, c4_results.Assim);
@@ -221,5 +230,33 @@ void c4_assimilation::do_operation() const
     update(iterations_op, c4_results.iterations);
 }
 
+
+/**
+ * @class c4_assimilation_brent
+ *
+ * @brief Identical to `c4_assimilation`, except that the coupled equations are
+ * solved for Ci using Brent's method rather than fixed-point iteration; see
+ * `ci_solver_method` for more details.
+ *
+ * The ``'iterations'`` output is the number of times the residual function was
+ * evaluated, which can be compared to the number of fixed-point iterations
+ * reported by `c4_assimilation`. If a solution cannot be bracketed, `c4photoC()`
+ * falls back to the fixed-point iteration.
+ */
+class c4_assimilation_brent : public c4_assimilation
+{
+   public:
+    c4_assimilation_brent(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : c4_assimilation{
+              input_quantities,
+              output_quantities,
+              ci_solver_method::brent}
+    {
+    }
+    static std::string get_name() { return "c4_assimilation_brent"; }
+};
+
 }  // namespace standardBML
 #endif
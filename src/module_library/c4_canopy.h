@@ -3,7 +3,9 @@
 
 #include "../framework/module.h"
 #include "../framework/state_map.h"
-#include "CanAC.h"  // For CanAC
+#include "CanAC.h"          // For CanAC
+#include "sunML.h"          // for sunML_cache
+#include "scratch_arena.h"  // for scratch_arena
 
 namespace standardBML
 {
@@ -135,6 +137,14 @@ class c4_canopy : public direct_module
     double* GrossAssim_CO2_op;
     double* canopy_photorespiration_rate_CO2_op;
 
+    // Light profile from the previous call, which is reused when its inputs
+    // have not changed
+    mutable sunML_cache light_cache;
+
+    // Memory for intermediate results, which is reused between calls to
+    // avoid repeated memory allocation
+    mutable scratch_arena scratch;
+
     // Main operation
     void do_operation() const;
 };
@@ -258,7 +268,9 @@ void c4_canopy::do_operation() const
         vmax1,
         windspeed,
         lnfun,
-        nlayers);
+        nlayers,
+        light_cache,
+        scratch);
 
     // Update the parameter list
     update(canopy_assimilation_rate_CO2_op, can_result.Assim);     // micromol / m^2 /s
@@ -3,6 +3,8 @@
 #include "leaf_energy_balance.h"  // for leaf_energy_balance
 
 using standardBML::c4_leaf_photosynthesis;
+using standardBML::c4_leaf_photosynthesis_batch;
+using standardBML::c4_leaf_photosynthesis_coupled;
 
 string_vector c4_leaf_photosynthesis::get_inputs()
 {
@@ -51,44 +53,51 @@ string_vector c4_leaf_photosynthesis::get_outputs()
     };
 }
 
+string_vector c4_leaf_photosynthesis_coupled::get_outputs()
+{
+    string_vector outputs = c4_leaf_photosynthesis::get_outputs();
+    outputs.push_back("iterations");  // not a physical quantity
+    return outputs;
+}
+
 void c4_leaf_photosynthesis::do_operation() const
 {
     // Make an initial guess for boundary layer conductance
     double const gbw_guess{1.2};  // mol / m^2 / s
 
-    // Get an initial estimate of stomatal conductance, assuming the leaf is at
-    // air temperature
-    const double initial_stomatal_conductance =
-        c4photoC(
-            incident_ppfd, ambient_temperature, ambient_temperature,
+    // Calculate assimilation, stomatal conductance, and Ci at a given leaf
+    // temperature
+    auto photosynthesis = [this](
+                              double leaf_temperature,
+                              double gbw,
+                              ci_solver_method ci_solver,
+                              photosynthesis_outputs const* initial_guess) {
+        return c4photoC(
+            incident_ppfd, leaf_temperature, ambient_temperature,
             rh, vmax1, alpha1, kparm, theta, beta,
             Rd, b0, b1, Gs_min, StomataWS, Catm, atmospheric_pressure,
-            upperT, lowerT, gbw_guess)
-            .Gs;  // mol / m^2 / s
-
-    // Calculate a new value for leaf temperature
-    const energy_balance_outputs et = leaf_energy_balance(
-        absorbed_longwave,
-        absorbed_shortwave,
-        atmospheric_pressure,
-        ambient_temperature,
-        gbw_canopy,
-        leafwidth,
-        rh,
-        initial_stomatal_conductance,
-        windspeed);
-
-    const double leaf_temperature = ambient_temperature + et.Deltat;  // deg. C
+            upperT, lowerT, gbw, ci_solver, initial_guess);
+    };
 
-    // Calculate final values for assimilation, stomatal conductance, and Ci
-    // using the new leaf temperature
-    const photosynthesis_outputs photo =
-        c4photoC(
-            incident_ppfd, leaf_temperature, ambient_temperature,
-            rh, vmax1, alpha1, kparm,
-            theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-            atmospheric_pressure, upperT, lowerT,
-            et.gbw_molecular);
+    // Calculate the leaf temperature for a given stomatal conductance
+    auto energy_balance = [this](double stomatal_conductance) {
+        return leaf_energy_balance(
+            absorbed_longwave,
+            absorbed_shortwave,
+            atmospheric_pressure,
+            ambient_temperature,
+            gbw_canopy,
+            leafwidth,
+            rh,
+            stomatal_conductance,
+            windspeed);
+    };
+
+    coupled_leaf_outputs const leaf = solve_leaf_photosynthesis(
+        photosynthesis, energy_balance, ambient_temperature, gbw_guess, solver);
+
+    photosynthesis_outputs const& photo = leaf.photo;
+    energy_balance_outputs const& et = leaf.et;
 
     // Update the outputs
     update(Assim_op, photo.Assim);
@@ -99,9 +108,92 @@ void c4_leaf_photosynthesis::do_operation() const
     update(gbw_op, et.gbw_molecular);
     update(GrossAssim_op, photo.GrossAssim);
     update(Gs_op, photo.Gs);
-    update(leaf_temperature_op, leaf_temperature);
+    update(leaf_temperature_op, leaf.leaf_temperature);
     update(RHs_op, photo.RHs);
     update(RH_canopy_op, et.RH_canopy);
     update(Rp_op, photo.Rp);
     update(TransR_op, et.TransR);
+
+    if (solver == leaf_solver_method::coupled) {
+        update(iterations_op, leaf.iterations);
+    }
+}
+
+void c4_leaf_photosynthesis_batch::do_operation() const
+{
+    size_t const n = incident_ppfd.size();
+
+    scratch_arena::frame const frame(scratch);
+
+    // Make an initial guess for boundary layer conductance
+    double const gbw_guess{1.2};  // mol / m^2 / s
+
+    // Get an initial estimate of stomatal conductance for each leaf, assuming
+    // the leaves are at air temperature
+    c4photo_batch_inputs photo_inputs;
+    photo_inputs.allocate(scratch, n);
+    for (size_t i = 0; i < n; ++i) {
+        photo_inputs.Qp[i] = incident_ppfd[i];
+        photo_inputs.leaf_temperature[i] = ambient_temperature[i];
+        photo_inputs.ambient_temperature[i] = ambient_temperature[i];
+        photo_inputs.relative_humidity[i] = rh[i];
+        photo_inputs.vmax[i] = vmax1[i];
+        photo_inputs.alpha[i] = alpha1[i];
+        photo_inputs.kparm[i] = kparm[i];
+        photo_inputs.theta[i] = theta[i];
+        photo_inputs.beta[i] = beta[i];
+        photo_inputs.Rd[i] = Rd[i];
+        photo_inputs.bb0[i] = b0[i];
+        photo_inputs.bb1[i] = b1[i];
+        photo_inputs.Gs_min[i] = Gs_min[i];
+        photo_inputs.StomaWS[i] = StomataWS[i];
+        photo_inputs.Ca[i] = Catm[i];
+        photo_inputs.atmospheric_pressure[i] = atmospheric_pressure[i];
+        photo_inputs.upperT[i] = upperT[i];
+        photo_inputs.lowerT[i] = lowerT[i];
+        photo_inputs.gbw[i] = gbw_guess;
+    }
+
+    auto photo = scratch.allocate<photosynthesis_outputs>(n);
+    c4photoC_batch(photo_inputs, photo, scratch);
+
+    // Calculate new values for leaf temperature and boundary layer
+    // conductance
+    auto et = scratch.allocate<energy_balance_outputs>(n);
+    for (size_t i = 0; i < n; ++i) {
+        et[i] = leaf_energy_balance(
+            absorbed_longwave[i],
+            absorbed_shortwave[i],
+            atmospheric_pressure[i],
+            ambient_temperature[i],
+            gbw_canopy[i],
+            leafwidth[i],
+            rh[i],
+            photo[i].Gs,
+            windspeed[i]);
+
+        photo_inputs.leaf_temperature[i] = ambient_temperature[i] + et[i].Deltat;  // degrees C
+        photo_inputs.gbw[i] = et[i].gbw_molecular;                                 // mol / m^2 / s
+    }
+
+    // Calculate final values for assimilation, stomatal conductance, and Ci
+    // using the new leaf temperatures
+    c4photoC_batch(photo_inputs, photo, scratch);
+
+    // Update the outputs
+    for (size_t i = 0; i < n; ++i) {
+        (*Assim_op)[i] = photo[i].Assim;
+        (*Ci_op)[i] = photo[i].Ci;
+        (*Cs_op)[i] = photo[i].Cs;
+        (*EPenman_op)[i] = et[i].EPenman;
+        (*EPriestly_op)[i] = et[i].EPriestly;
+        (*gbw_op)[i] = et[i].gbw_molecular;
+        (*GrossAssim_op)[i] = photo[i].GrossAssim;
+        (*Gs_op)[i] = photo[i].Gs;
+        (*leaf_temperature_op)[i] = photo_inputs.leaf_temperature[i];
+        (*RHs_op)[i] = photo[i].RHs;
+        (*RH_canopy_op)[i] = et[i].RH_canopy;
+        (*Rp_op)[i] = photo[i].Rp;
+        (*TransR_op)[i] = et[i].TransR;
+    }
 }
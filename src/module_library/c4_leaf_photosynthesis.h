@@ -1,11 +1,125 @@
 #ifndef C4_LEAF_PHOTOSYNTHESIS_H
 #define C4_LEAF_PHOTOSYNTHESIS_H
 
+#include <vector>
 #include "../framework/state_map.h"
 #include "../framework/module.h"
+#include "coupled_leaf_solver.h"  // for leaf_solver_method
+#include "c4photo.h"              // for c4photo_batch_inputs
+#include "leaf_energy_balance.h"  // for energy_balance_outputs
+#include "leaf_batch.h"           // for leaf_batch
+#include "scratch_arena.h"        // for scratch_arena
 
 namespace standardBML
 {
+class c4_leaf_photosynthesis;
+
+/**
+ * @class c4_leaf_photosynthesis_batch
+ *
+ * @brief The batched version of `c4_leaf_photosynthesis`; see `leaf_batch` for
+ * more details. Photosynthesis is calculated for all leaves at once using
+ * `c4photoC_batch()`.
+ */
+class c4_leaf_photosynthesis_batch : public leaf_batch
+{
+   public:
+    using module_type = c4_leaf_photosynthesis;
+
+    c4_leaf_photosynthesis_batch(
+        state_vector_map const& input_quantities,
+        state_vector_map* output_quantities)
+        : leaf_batch{},
+
+          // Get references to input quantity vectors
+          absorbed_longwave{get_batch_input(input_quantities, "absorbed_longwave")},
+          absorbed_shortwave{get_batch_input(input_quantities, "absorbed_shortwave")},
+          alpha1{get_batch_input(input_quantities, "alpha1")},
+          ambient_temperature{get_batch_input(input_quantities, "temp")},
+          atmospheric_pressure{get_batch_input(input_quantities, "atmospheric_pressure")},
+          b0{get_batch_input(input_quantities, "b0")},
+          b1{get_batch_input(input_quantities, "b1")},
+          beta{get_batch_input(input_quantities, "beta")},
+          Catm{get_batch_input(input_quantities, "Catm")},
+          gbw_canopy{get_batch_input(input_quantities, "gbw_canopy")},
+          Gs_min{get_batch_input(input_quantities, "Gs_min")},
+          incident_ppfd{get_batch_input(input_quantities, "incident_ppfd")},
+          kparm{get_batch_input(input_quantities, "kparm")},
+          leafwidth{get_batch_input(input_quantities, "leafwidth")},
+          lowerT{get_batch_input(input_quantities, "lowerT")},
+          Rd{get_batch_input(input_quantities, "Rd")},
+          rh{get_batch_input(input_quantities, "rh")},
+          StomataWS{get_batch_input(input_quantities, "StomataWS")},
+          theta{get_batch_input(input_quantities, "theta")},
+          upperT{get_batch_input(input_quantities, "upperT")},
+          vmax1{get_batch_input(input_quantities, "vmax1")},
+          windspeed{get_batch_input(input_quantities, "windspeed")},
+
+          // Get pointers to output quantity vectors
+          Assim_op{get_batch_op(output_quantities, "Assim")},
+          Ci_op{get_batch_op(output_quantities, "Ci")},
+          Cs_op{get_batch_op(output_quantities, "Cs")},
+          EPenman_op{get_batch_op(output_quantities, "EPenman")},
+          EPriestly_op{get_batch_op(output_quantities, "EPriestly")},
+          gbw_op{get_batch_op(output_quantities, "gbw")},
+          GrossAssim_op{get_batch_op(output_quantities, "GrossAssim")},
+          Gs_op{get_batch_op(output_quantities, "Gs")},
+          leaf_temperature_op{get_batch_op(output_quantities, "leaf_temperature")},
+          RHs_op{get_batch_op(output_quantities, "RHs")},
+          RH_canopy_op{get_batch_op(output_quantities, "RH_canopy")},
+          Rp_op{get_batch_op(output_quantities, "Rp")},
+          TransR_op{get_batch_op(output_quantities, "TransR")}
+    {
+    }
+
+   private:
+    // References to input quantity vectors
+    std::vector<double> const& absorbed_longwave;
+    std::vector<double> const& absorbed_shortwave;
+    std::vector<double> const& alpha1;
+    std::vector<double> const& ambient_temperature;
+    std::vector<double> const& atmospheric_pressure;
+    std::vector<double> const& b0;
+    std::vector<double> const& b1;
+    std::vector<double> const& beta;
+    std::vector<double> const& Catm;
+    std::vector<double> const& gbw_canopy;
+    std::vector<double> const& Gs_min;
+    std::vector<double> const& incident_ppfd;
+    std::vector<double> const& kparm;
+    std::vector<double> const& leafwidth;
+    std::vector<double> const& lowerT;
+    std::vector<double> const& Rd;
+    std::vector<double> const& rh;
+    std::vector<double> const& StomataWS;
+    std::vector<double> const& theta;
+    std::vector<double> const& upperT;
+    std::vector<double> const& vmax1;
+    std::vector<double> const& windspeed;
+
+    // Pointers to output quantity vectors
+    std::vector<double>* Assim_op;
+    std::vector<double>* Ci_op;
+    std::vector<double>* Cs_op;
+    std::vector<double>* EPenman_op;
+    std::vector<double>* EPriestly_op;
+    std::vector<double>* gbw_op;
+    std::vector<double>* GrossAssim_op;
+    std::vector<double>* Gs_op;
+    std::vector<double>* leaf_temperature_op;
+    std::vector<double>* RHs_op;
+    std::vector<double>* RH_canopy_op;
+    std::vector<double>* Rp_op;
+    std::vector<double>* TransR_op;
+
+    // Memory for intermediate results, which is reused between calls to
+    // avoid repeated memory allocation
+    mutable scratch_arena scratch;
+
+    // Main operation
+    void do_operation() const;
+};
+
 /**
  * @class c4_leaf_photosynthesis
  *
@@ -17,9 +131,13 @@ class c4_leaf_photosynthesis : public direct_module
    public:
     c4_leaf_photosynthesis(
         state_map const& input_quantities,
-        state_map* output_quantities)
+        state_map* output_quantities,
+        leaf_solver_method solver = leaf_solver_method::two_pass)
         : direct_module{},
 
+          // Store the method used to find the leaf temperature
+          solver{solver},
+
           // Get references to input quantities
           absorbed_longwave{get_input(input_quantities, "absorbed_longwave")},
           absorbed_shortwave{get_input(input_quantities, "absorbed_shortwave")},
@@ -57,14 +175,24 @@ class c4_leaf_photosynthesis : public direct_module
           RHs_op{get_op(output_quantities, "RHs")},
           RH_canopy_op{get_op(output_quantities, "RH_canopy")},
           Rp_op{get_op(output_quantities, "Rp")},
-          TransR_op{get_op(output_quantities, "TransR")}
+          TransR_op{get_op(output_quantities, "TransR")},
+          iterations_op{
+              solver == leaf_solver_method::coupled
+                  ? get_op(output_quantities, "iterations")
+                  : nullptr}
     {
     }
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "c4_leaf_photosynthesis"; }
 
+    // Batched version of this module
+    using batch_type = c4_leaf_photosynthesis_batch;
+
    private:
+    // Method used to find the leaf temperature
+    leaf_solver_method const solver;
+
     // References to input quantities
     double const& absorbed_longwave;
     double const& absorbed_shortwave;
@@ -103,10 +231,37 @@ class c4_leaf_photosynthesis : public direct_module
     double* RH_canopy_op;
     double* Rp_op;
     double* TransR_op;
+    double* iterations_op;  // only used with the coupled solver
 
     // Main operation
     void do_operation() const;
 };
 
+/**
+ * @class c4_leaf_photosynthesis_coupled
+ *
+ * @brief Identical to `c4_leaf_photosynthesis`, except that the photosynthesis and
+ * energy balance calculations are iterated until the leaf temperature
+ * converges; see `leaf_solver_method` for more details.
+ *
+ * This module has one additional output: ``'iterations'``, the total number of
+ * photosynthesis iterations used by all of the photosynthesis calculations.
+ */
+class c4_leaf_photosynthesis_coupled : public c4_leaf_photosynthesis
+{
+   public:
+    c4_leaf_photosynthesis_coupled(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : c4_leaf_photosynthesis{
+              input_quantities,
+              output_quantities,
+              leaf_solver_method::coupled}
+    {
+    }
+    static string_vector get_outputs();
+    static std::string get_name() { return "c4_leaf_photosynthesis_coupled"; }
+};
+
 }  // namespace standardBML
 #endif
@@ -1,6 +1,10 @@
 #include <cmath>                          // for pow, exp, std::abs
-#include "ball_berry_gs.h"                // for ball_berry_gs
+#include <algorithm>                      // for std::min
+#include <vector>
+#include "ball_berry_gs.h"                // for ball_berry_gs, ball_berry_gs_swvp, ball_berry_swvp_ratio
 #include "conductance_limited_assim.h"    // for conductance_limited_assim
+#include "ci_solver.h"                    // for ci_solver_method, solve_ci_brent
+#include "leaf_solver_statistics.h"       // for record_leaf_solver_call, leaf_solver
 #include "../framework/constants.h"       // for dr_stomata, dr_boundary
 #include "../framework/quadratic_root.h"  // for quadratic_root_min
 #include "c4photo.h"
@@ -8,16 +12,29 @@
 using physical_constants::dr_boundary;
 using physical_constants::dr_stomata;
 
-photosynthesis_outputs c4photoC(
+namespace
+{
+/**
+ * @brief Quantities used by `c4photoC()` that depend on the leaf temperature
+ * and other inputs, but not on the intercellular CO2 concentration, so they
+ * only need to be calculated once per leaf.
+ */
+struct c4_leaf_constants {
+    double Ca_pa;    // Pa
+    double kT;       // dimensionless
+    double RT;       // micromol / m^2 / s
+    double M;        // micromol / m^2 / s
+    double bb0_adj;  // mol / m^2 / s
+    double bb1_adj;  // dimensionless
+};
+
+c4_leaf_constants get_c4_leaf_constants(
     double const Qp,                    // micromol / m^2 / s
     double const leaf_temperature,      // degrees C
-    double const ambient_temperature,   // degrees C
-    double const relative_humidity,     // dimensionless from Pa / Pa
     double const vmax,                  // micromol / m^2 / s
     double const alpha,                 // mol / mol
     double const kparm,                 // mol / m^2 / s
     double const theta,                 // dimensionless
-    double const beta,                  // dimensionless
     double const Rd,                    // micromol / m^2 / s
     double const bb0,                   // mol / m^2 / s
     double const bb1,                   // dimensionless from [mol / m^2 / s] / [mol / m^2 / s]
@@ -26,8 +43,7 @@ photosynthesis_outputs c4photoC(
     double const Ca,                    // micromol / mol
     double const atmospheric_pressure,  // Pa
     double const upperT,                // degrees C
-    double const lowerT,                // degrees C
-    double const gbw                    // mol / m^2 / s
+    double const lowerT                 // degrees C
 )
 {
     constexpr double k_Q10 = 2;  // dimensionless. Increase in a reaction rate per temperature increase of 10 degrees Celsius.
@@ -59,6 +75,243 @@ photosynthesis_outputs c4photoC(
     double const bb0_adj = StomaWS * bb0 + Gs_min * (1.0 - StomaWS);
     double const bb1_adj = StomaWS * bb1;
 
+    return c4_leaf_constants{Ca_pa, kT, RT, M, bb0_adj, bb1_adj};
+}
+
+/**
+ * @brief Calculates the net assimilation rate from the intercellular CO2
+ * concentration, as done in each iteration of the `c4photoC()` loop.
+ */
+inline double c4_net_assim(
+    c4_leaf_constants const& lc,
+    double const InterCellularCO2,      // Pa
+    double const atmospheric_pressure,  // Pa
+    double const beta                   // dimensionless
+)
+{
+    // Collatz 1992. Appendix B. Quadratic coefficients from Equation 3B.
+    double kT_IC_P = lc.kT * InterCellularCO2 / atmospheric_pressure * 1e6;  // micromole / m^2 / s
+    double a = beta;
+    double b = -(lc.M + kT_IC_P);
+    double c = lc.M * kT_IC_P;
+
+    // Calculate the smaller of the two quadratic roots, as mentioned
+    // following Equation 3B in Collatz 1992.
+    double gross_assim = quadratic_root_min(a, b, c);  // micromol / m^2 / s
+
+    return gross_assim - lc.RT;  // micromole / m^2 / s.
+}
+
+int constexpr c4_max_iterations = 50;
+double constexpr c4_tolerance = 0.1;  // micromole / m^2 / s
+
+/**
+ * @brief Calculates the `c4photoC()` outputs for a leaf that receives no light.
+ *
+ * Without light, the gross assimilation rate is zero for any Ci, so the fixed
+ * point loop in `c4photoC()` finds a net assimilation rate of `-RT` on its first
+ * pass, along with the Ball-Berry stomatal conductance for that rate. The loop
+ * stops there if `-RT` is within the tolerance of the starting assimilation
+ * rate; otherwise, it makes a second pass that reproduces the same values and
+ * then stops. Here the outputs of those passes are calculated directly,
+ * including the conductance-limited assimilation rate, which uses the stomatal
+ * conductance from the start of the last pass, and the number of iterations,
+ * which is the number of passes minus one.
+ *
+ * This assumes that respiration is not negative, so that the conductance limit
+ * never applies.
+ */
+photosynthesis_outputs c4photoC_dark(
+    c4_leaf_constants const& lc,
+    double const swvp_ratio,            // dimensionless
+    double const relative_humidity,     // dimensionless from Pa / Pa
+    double const Ca,                    // micromol / mol
+    double const atmospheric_pressure,  // Pa
+    double const gbw,                   // mol / m^2 / s
+    double const initial_Assim,         // micromol / m^2 / s
+    double const initial_Gs             // mol / m^2 / s
+)
+{
+    double const Assim = -lc.RT;  // micromol / m^2 / s
+
+    stomata_outputs const BB_res = ball_berry_gs_swvp(
+        Assim * 1e-6,
+        Ca * 1e-6,
+        relative_humidity,
+        lc.bb0_adj,
+        lc.bb1_adj,
+        gbw,
+        swvp_ratio);
+
+    double const Gs = BB_res.gsw;  // mol / m^2 / s
+
+    double const InterCellularCO2 =
+        lc.Ca_pa - atmospheric_pressure * (Assim * 1e-6) *
+                       (dr_boundary / gbw + dr_stomata / Gs);  // Pa
+
+    int const iterations =
+        std::abs(initial_Assim - Assim) >= c4_tolerance ? 1 : 0;
+
+    double const an_conductance = conductance_limited_assim(
+        Ca, gbw, iterations == 0 ? initial_Gs : Gs);  // micromol / m^2 / s
+
+    return photosynthesis_outputs{
+        /* .Assim = */ Assim,                                        // micromol / m^2 /s
+        /* .Assim_conductance = */ an_conductance,                   // micromol / m^2 / s
+        /* .Ci = */ InterCellularCO2 / atmospheric_pressure * 1e6,  // micromol / mol
+        /* .GrossAssim = */ Assim + lc.RT,                           // micromol / m^2 / s
+        /* .Gs = */ Gs,                                              // mol / m^2 / s
+        /* .Cs = */ BB_res.cs,                                       // micromol / m^2 / s
+        /* .RHs = */ BB_res.hs,                                      // dimensionless from Pa / Pa
+        /* .Rp = */ 0,                                               // micromol / m^2 / s
+        /* .iterations = */ iterations                               // not a physical quantity
+    };
+}
+
+/**
+ * @brief Solves the coupled assimilation and stomatal conductance equations for
+ * a C4 leaf using `solve_ci_brent()`.
+ *
+ * As in the fixed point loop of `c4photoC()`, the net assimilation rate is
+ * limited by conductance so that Ci and the CO2 concentration at the leaf
+ * surface can never become negative. Here the limit is calculated using the
+ * initial guess for the stomatal conductance from the fixed point loop, which
+ * keeps the residual function independent of the solver history; the limit
+ * always exceeds the assimilation rate at the solution, so it does not change
+ * the result.
+ *
+ * @return `true` if a solution was found and stored in `result`.
+ */
+bool c4photoC_brent(
+    c4_leaf_constants const& lc,
+    double const leaf_temperature,      // degrees C
+    double const ambient_temperature,   // degrees C
+    double const relative_humidity,     // dimensionless from Pa / Pa
+    double const beta,                  // dimensionless
+    double const Ca,                    // micromol / mol
+    double const atmospheric_pressure,  // Pa
+    double const gbw,                   // mol / m^2 / s
+    double const* Ci_guess,             // micromol / mol (optional)
+    photosynthesis_outputs& result)
+{
+    double const an_max =
+        conductance_limited_assim(Ca, gbw, 1e3);  // micromol / m^2 / s
+
+    stomata_outputs BB_res;
+    double Assim{};   // micromol / m^2 / s
+    double Gs{};      // mol / m^2 / s
+    double Ci_new{};  // micromol / mol
+
+    auto residual = [&](double Ci) {
+        Assim = std::min(
+            c4_net_assim(lc, Ci * 1e-6 * atmospheric_pressure, atmospheric_pressure, beta),
+            an_max);  // micromol / m^2 / s
+
+        BB_res = ball_berry_gs(
+            Assim * 1e-6,
+            Ca * 1e-6,
+            relative_humidity,
+            lc.bb0_adj,
+            lc.bb1_adj,
+            gbw,
+            leaf_temperature,
+            ambient_temperature);
+
+        Gs = BB_res.gsw;  // mol / m^2 / s
+
+        Ci_new = Ca - Assim * (dr_boundary / gbw + dr_stomata / Gs);  // micromol / mol
+
+        return Ci_new - Ci;  // micromol / mol
+    };
+
+    double Ci{};  // micromol / mol
+    int evaluations{0};
+    bool const found = solve_ci_brent(residual, Ca, Ci, evaluations, Ci_guess);
+
+    record_leaf_solver_call(leaf_solver::c4photoC_brent, evaluations, found);
+
+    if (!found) {
+        return false;
+    }
+
+    // Make sure the stored state corresponds to the solution
+    residual(Ci);
+
+    result = photosynthesis_outputs{
+        /* .Assim = */ Assim,                                               // micromol / m^2 /s
+        /* .Assim_conductance = */ conductance_limited_assim(Ca, gbw, Gs),  // micromol / m^2 / s
+        /* .Ci = */ Ci_new,                                                 // micromol / mol
+        /* .GrossAssim = */ Assim + lc.RT,                                  // micromol / m^2 / s
+        /* .Gs = */ Gs,                                                     // mol / m^2 / s
+        /* .Cs = */ BB_res.cs,                                              // micromol / m^2 / s
+        /* .RHs = */ BB_res.hs,                                             // dimensionless from Pa / Pa
+        /* .Rp = */ 0,                                                      // micromol / m^2 / s
+        /* .iterations = */ evaluations                                     // not a physical quantity
+    };
+
+    return true;
+}
+
+}  // namespace
+
+photosynthesis_outputs c4photoC(
+    double const Qp,                             // micromol / m^2 / s
+    double const leaf_temperature,               // degrees C
+    double const ambient_temperature,            // degrees C
+    double const relative_humidity,              // dimensionless from Pa / Pa
+    double const vmax,                           // micromol / m^2 / s
+    double const alpha,                          // mol / mol
+    double const kparm,                          // mol / m^2 / s
+    double const theta,                          // dimensionless
+    double const beta,                           // dimensionless
+    double const Rd,                             // micromol / m^2 / s
+    double const bb0,                            // mol / m^2 / s
+    double const bb1,                            // dimensionless from [mol / m^2 / s] / [mol / m^2 / s]
+    double const Gs_min,                         // mol / m^2 / s
+    double const StomaWS,                        // dimensionless
+    double const Ca,                             // micromol / mol
+    double const atmospheric_pressure,           // Pa
+    double const upperT,                         // degrees C
+    double const lowerT,                         // degrees C
+    double const gbw,                            // mol / m^2 / s
+    ci_solver_method const solver,               // selects the method used to find Ci
+    photosynthesis_outputs const* initial_guess  // optional starting point for the fixed point loop
+)
+{
+    c4_leaf_constants const lc = get_c4_leaf_constants(
+        Qp, leaf_temperature, vmax, alpha, kparm, theta, Rd, bb0, bb1, Gs_min,
+        StomaWS, Ca, atmospheric_pressure, upperT, lowerT);
+
+    // Use Brent's method if requested, falling back to the fixed point loop if
+    // a solution cannot be bracketed
+    photosynthesis_outputs brent_result;
+    if (solver == ci_solver_method::brent &&
+        c4photoC_brent(
+            lc, leaf_temperature, ambient_temperature, relative_humidity, beta,
+            Ca, atmospheric_pressure, gbw,
+            initial_guess ? &initial_guess->Ci : nullptr, brent_result)) {
+        return brent_result;
+    }
+
+    // There is nothing to iterate over when the leaf receives no light
+    if (Qp == 0) {
+        photosynthesis_outputs const dark_result = c4photoC_dark(
+            lc, ball_berry_swvp_ratio(leaf_temperature, ambient_temperature),
+            relative_humidity, Ca, atmospheric_pressure, gbw,
+            initial_guess ? initial_guess->Assim : 0.0,
+            initial_guess ? initial_guess->Gs : 1e3);
+
+        record_leaf_solver_call(
+            leaf_solver::c4photoC, dark_result.iterations, true);
+
+        return dark_result;
+    }
+
+    double const Ca_pa = lc.Ca_pa;      // Pa
+    double const RT = lc.RT;            // micromol / m^2 / s
+    double const bb0_adj = lc.bb0_adj;  // mol / m^2 / s
+    double const bb1_adj = lc.bb1_adj;  // dimensionless
+
     // Initialize loop variables. Here we make an initial guess that
     // Ci = 0.4 * Ca.
     stomata_outputs BB_res;
@@ -66,23 +319,22 @@ photosynthesis_outputs c4photoC(
     double Assim{};                        // micromol / m^2 / s
     double Gs{1e3};                        // mol / m^2 / s
     double an_conductance{};               // micromol / m^2 / s
+    double OldAssim{0.0};                  // micromol / m^2 / s
+
+    // If a previous solution for similar conditions is available, start from
+    // it instead
+    if (initial_guess) {
+        InterCellularCO2 = initial_guess->Ci * 1e-6 * atmospheric_pressure;  // Pa
+        Gs = initial_guess->Gs;                                              // mol / m^2 / s
+        OldAssim = initial_guess->Assim;                                     // micromol / m^2 / s
+    }
 
     // Start the loop
-    double OldAssim = 0.0, Tol = 0.1, diff;
+    double Tol = c4_tolerance, diff;
     int iterCounter = 0;
-    int constexpr max_iterations = 50;
+    int constexpr max_iterations = c4_max_iterations;
     do {
-        // Collatz 1992. Appendix B. Quadratic coefficients from Equation 3B.
-        double kT_IC_P = kT * InterCellularCO2 / atmospheric_pressure * 1e6;  // micromole / m^2 / s
-        double a = beta;
-        double b = -(M + kT_IC_P);
-        double c = M * kT_IC_P;
-
-        // Calculate the smaller of the two quadratic roots, as mentioned
-        // following Equation 3B in Collatz 1992.
-        double gross_assim = quadratic_root_min(a, b, c);  // micromol / m^2 / s
-
-        Assim = gross_assim - RT;  // micromole / m^2 / s.
+        Assim = c4_net_assim(lc, InterCellularCO2, atmospheric_pressure, beta);  // micromole / m^2 / s.
 
         // The net CO2 assimilation is the smaller of the biochemistry-limited
         // and conductance-limited rates. This will prevent the calculated Ci
@@ -129,6 +381,10 @@ photosynthesis_outputs c4photoC(
     //if (iterCounter > 49)
     //Rprintf("Counter %i; Ci %f; Assim %f; Gs %f; leaf_temperature %f\n", iterCounter, InterCellularCO2 / atmospheric_pressure * 1e6, Assim, Gs, leaf_temperature);
 
+    record_leaf_solver_call(
+        leaf_solver::c4photoC, iterCounter,
+        iterCounter <= max_iterations - 10);
+
     double Ci = InterCellularCO2 / atmospheric_pressure * 1e6;  // micromole / mol
 
     return photosynthesis_outputs{
@@ -143,3 +399,170 @@ photosynthesis_outputs c4photoC(
         /* .iterations = */ iterCounter             // not a physical quantity
     };
 }
+
+void c4photo_batch_inputs::allocate(scratch_arena& scratch, size_t n)
+{
+    for (scratch_span<double>* v :
+         {&Qp, &leaf_temperature, &ambient_temperature, &relative_humidity,
+          &vmax, &alpha, &kparm, &theta, &beta, &Rd, &bb0, &bb1, &Gs_min,
+          &StomaWS, &Ca, &atmospheric_pressure, &upperT, &lowerT, &gbw}) {
+        *v = scratch.allocate<double>(n);
+    }
+}
+
+void c4photo_batch_inputs::truncate(size_t n)
+{
+    for (scratch_span<double>* v :
+         {&Qp, &leaf_temperature, &ambient_temperature, &relative_humidity,
+          &vmax, &alpha, &kparm, &theta, &beta, &Rd, &bb0, &bb1, &Gs_min,
+          &StomaWS, &Ca, &atmospheric_pressure, &upperT, &lowerT, &gbw}) {
+        v->truncate(n);
+    }
+}
+
+/**
+ * @brief Applies `c4photoC()` to a batch of leaves at once.
+ *
+ * The leaves are iterated in lockstep: each pass of the convergence loop
+ * updates every leaf that has not yet converged, and leaves are removed from
+ * the active set as soon as they meet the same stopping criteria used by
+ * `c4photoC()`. Quantities that do not change during the loop, including the
+ * saturation water vapor pressure ratio used by the Ball-Berry model, are
+ * calculated once per leaf beforehand, and leaves that receive no light never
+ * enter the loop.
+ *
+ * The loop itself is not vectorized: each pass reaches the active leaves
+ * through a list of indices, and the stomatal conductance is calculated by
+ * `ball_berry_gs_swvp()`, which is defined in another translation unit. The
+ * savings come from calculating the per-leaf constants only once and from
+ * skipping leaves that have already converged.
+ *
+ * Each leaf goes through exactly the same sequence of floating-point
+ * operations as in `c4photoC()`, so the outputs, including the number of
+ * iterations, are identical to calling `c4photoC()` separately for each leaf.
+ *
+ * The results are stored in `outputs`, which must have one element per leaf.
+ * Intermediate arrays are allocated from `scratch` and released before
+ * returning.
+ */
+void c4photoC_batch(
+    c4photo_batch_inputs const& inputs,
+    scratch_span<photosynthesis_outputs> outputs,
+    scratch_arena& scratch)
+{
+    size_t const n = inputs.size();
+
+    scratch_arena::frame const frame(scratch);
+
+    auto lc = scratch.allocate<c4_leaf_constants>(n);
+    auto swvp_ratio = scratch.allocate<double>(n);        // dimensionless
+    auto InterCellularCO2 = scratch.allocate<double>(n);  // Pa
+    auto Assim = scratch.allocate<double>(n);             // micromol / m^2 / s
+    auto Gs = scratch.allocate<double>(n, 1e3);           // mol / m^2 / s
+    auto an_conductance = scratch.allocate<double>(n);    // micromol / m^2 / s
+    auto OldAssim = scratch.allocate<double>(n, 0.0);     // micromol / m^2 / s
+    auto BB_res = scratch.allocate<stomata_outputs>(n);
+    auto iterCounter = scratch.allocate<int>(n, 0);
+    auto active = scratch.allocate<size_t>(n);
+    size_t n_active = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        lc[i] = get_c4_leaf_constants(
+            inputs.Qp[i], inputs.leaf_temperature[i], inputs.vmax[i],
+            inputs.alpha[i], inputs.kparm[i], inputs.theta[i], inputs.Rd[i],
+            inputs.bb0[i], inputs.bb1[i], inputs.Gs_min[i], inputs.StomaWS[i],
+            inputs.Ca[i], inputs.atmospheric_pressure[i], inputs.upperT[i],
+            inputs.lowerT[i]);
+
+        swvp_ratio[i] = ball_berry_swvp_ratio(
+            inputs.leaf_temperature[i], inputs.ambient_temperature[i]);
+
+        InterCellularCO2[i] = 0.4 * lc[i].Ca_pa;
+
+        if (inputs.Qp[i] == 0) {
+            outputs[i] = c4photoC_dark(
+                lc[i], swvp_ratio[i], inputs.relative_humidity[i], inputs.Ca[i],
+                inputs.atmospheric_pressure[i], inputs.gbw[i], OldAssim[i],
+                Gs[i]);
+
+            record_leaf_solver_call(
+                leaf_solver::c4photoC, outputs[i].iterations, true);
+        } else {
+            active[n_active++] = i;
+        }
+    }
+    active.truncate(n_active);
+
+    while (!active.empty()) {
+        // Biochemistry- and conductance-limited assimilation
+        for (size_t const i : active) {
+            double const A = c4_net_assim(
+                lc[i], InterCellularCO2[i], inputs.atmospheric_pressure[i],
+                inputs.beta[i]);
+
+            an_conductance[i] =
+                conductance_limited_assim(inputs.Ca[i], inputs.gbw[i], Gs[i]);
+
+            Assim[i] = std::min(A, an_conductance[i]);
+        }
+
+        // Stomatal conductance
+        for (size_t const i : active) {
+            BB_res[i] = ball_berry_gs_swvp(
+                Assim[i] * 1e-6,
+                inputs.Ca[i] * 1e-6,
+                inputs.relative_humidity[i],
+                lc[i].bb0_adj,
+                lc[i].bb1_adj,
+                inputs.gbw[i],
+                swvp_ratio[i]);
+
+            Gs[i] = iterCounter[i] > c4_max_iterations - 10
+                        ? inputs.bb0[i]
+                        : BB_res[i].gsw;
+        }
+
+        // Intercellular CO2 and convergence checks; converged leaves are
+        // removed from the active set while preserving the order of the rest
+        n_active = 0;
+        for (size_t const i : active) {
+            double const P = inputs.atmospheric_pressure[i];
+
+            InterCellularCO2[i] =
+                lc[i].Ca_pa - P * (Assim[i] * 1e-6) *
+                                  (dr_boundary / inputs.gbw[i] + dr_stomata / Gs[i]);  // Pa
+
+            double const diff = std::abs(OldAssim[i] - Assim[i]);  // micromole / m^2 / s
+
+            OldAssim[i] = Assim[i];
+
+            if (diff >= c4_tolerance && ++iterCounter[i] < c4_max_iterations) {
+                active[n_active++] = i;
+            }
+        }
+        active.truncate(n_active);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        // Leaves without light were already handled above
+        if (inputs.Qp[i] == 0) {
+            continue;
+        }
+
+        record_leaf_solver_call(
+            leaf_solver::c4photoC, iterCounter[i],
+            iterCounter[i] <= c4_max_iterations - 10);
+
+        outputs[i] = photosynthesis_outputs{
+            /* .Assim = */ Assim[i],                                                  // micromol / m^2 /s
+            /* .Assim_conductance = */ an_conductance[i],                             // micromol / m^2 / s
+            /* .Ci = */ InterCellularCO2[i] / inputs.atmospheric_pressure[i] * 1e6,  // micromol / mol
+            /* .GrossAssim = */ Assim[i] + lc[i].RT,                                  // micromol / m^2 / s
+            /* .Gs = */ Gs[i],                                                        // mol / m^2 / s
+            /* .Cs = */ BB_res[i].cs,                                                 // micromol / m^2 / s
+            /* .RHs = */ BB_res[i].hs,                                                // dimensionless from Pa / Pa
+            /* .Rp = */ 0,                                                            // micromol / m^2 / s
+            /* .iterations = */ iterCounter[i]                                        // not a physical quantity
+        };
+    }
+}
@@ -1,7 +1,10 @@
 #ifndef C4PHOTO_H
 #define C4PHOTO_H
 
+#include <cstddef>                   // for size_t
 #include "photosynthesis_outputs.h"  // for photosynthesis_outputs
+#include "ci_solver.h"               // for ci_solver_method
+#include "scratch_arena.h"           // for scratch_arena, scratch_span
 
 photosynthesis_outputs c4photoC(
     double const Qp,
@@ -22,6 +25,44 @@ photosynthesis_outputs c4photoC(
     double const atmospheric_pressure,
     double const upperT,
     double const lowerT,
-    double const gbw);
+    double const gbw,
+    ci_solver_method const solver = ci_solver_method::fixed_point,
+    photosynthesis_outputs const* initial_guess = nullptr);
+
+/**
+ * @brief Inputs to `c4photoC_batch()` stored as a structure of arrays, where
+ * element `i` of each array holds the corresponding `c4photoC()` argument for
+ * leaf `i` of the batch. The arrays are allocated from a `scratch_arena`.
+ */
+struct c4photo_batch_inputs {
+    scratch_span<double> Qp;
+    scratch_span<double> leaf_temperature;
+    scratch_span<double> ambient_temperature;
+    scratch_span<double> relative_humidity;
+    scratch_span<double> vmax;
+    scratch_span<double> alpha;
+    scratch_span<double> kparm;
+    scratch_span<double> theta;
+    scratch_span<double> beta;
+    scratch_span<double> Rd;
+    scratch_span<double> bb0;
+    scratch_span<double> bb1;
+    scratch_span<double> Gs_min;
+    scratch_span<double> StomaWS;
+    scratch_span<double> Ca;
+    scratch_span<double> atmospheric_pressure;
+    scratch_span<double> upperT;
+    scratch_span<double> lowerT;
+    scratch_span<double> gbw;
+
+    void allocate(scratch_arena& scratch, size_t n);
+    void truncate(size_t n);
+    size_t size() const { return Qp.size(); }
+};
+
+void c4photoC_batch(
+    c4photo_batch_inputs const& inputs,
+    scratch_span<photosynthesis_outputs> outputs,
+    scratch_arena& scratch);
 
 #endif
@@ -0,0 +1,242 @@
+#ifndef CI_SOLVER_H
+#define CI_SOLVER_H
+
+#include <algorithm>  // for std::min, std::max
+#include <cmath>      // for std::abs, std::copysign
+#include <limits>     // for std::numeric_limits
+
+/**
+ * @brief Methods for finding the intercellular CO2 concentration (Ci) that is
+ * consistent with the coupled biochemical and stomatal conductance models.
+ *
+ * - `fixed_point`: The original approach used by `c3photoC()` and
+ *   `c4photoC()`, where the net assimilation rate, stomatal conductance, and
+ *   Ci are repeatedly updated from each other until the assimilation rate stops
+ *   changing.
+ *
+ * - `brent`: The same coupled system is written as a single equation
+ *   `F(Ci) = 0`, where `F(Ci)` is the difference between the Ci calculated
+ *   from the flux equation and the Ci used to calculate the assimilation rate.
+ *   A root of `F` is first bracketed and then located using Brent's method,
+ *   which combines inverse quadratic interpolation and secant steps with a
+ *   bisection safeguard. This typically requires only a handful of evaluations
+ *   of `F`, even under conditions where the fixed point iteration converges
+ *   slowly.
+ */
+enum class ci_solver_method {
+    fixed_point,
+    brent
+};
+
+double constexpr ci_solver_tolerance = 1e-3;  // micromol / mol
+int constexpr ci_solver_max_iterations = 100;
+int constexpr ci_solver_max_bracket_expansions = 10;
+double constexpr ci_solver_warm_start_width = 1;  // micromol / mol
+
+/**
+ * @brief Finds a root of `F` using Brent's method, following the `zbrent`
+ * routine from Numerical Recipes.
+ *
+ * A root must be bracketed by `a` and `b`, so that `fa = F(a)` and
+ * `fb = F(b)` have opposite signs. Each evaluation of `F` increments
+ * `evaluations`.
+ */
+template <typename residual_function>
+double brent_root(
+    residual_function const& F,
+    double a,
+    double b,
+    double fa,
+    double fb,
+    double const tolerance,
+    int const max_iterations,
+    int& evaluations)
+{
+    double constexpr eps = std::numeric_limits<double>::epsilon();
+
+    double c = b;
+    double fc = fb;
+    double d = b - a;
+    double e = d;
+
+    for (int i = 0; i < max_iterations; ++i) {
+        if ((fb > 0.0 && fc > 0.0) || (fb < 0.0 && fc < 0.0)) {
+            // Make sure `b` and `c` bracket the root
+            c = a;
+            fc = fa;
+            d = b - a;
+            e = d;
+        }
+
+        if (std::abs(fc) < std::abs(fb)) {
+            // Make `b` the best estimate of the root
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        double const tol1 = 2.0 * eps * std::abs(b) + 0.5 * tolerance;
+        double const xm = 0.5 * (c - b);
+
+        if (std::abs(xm) <= tol1 || fb == 0.0) {
+            return b;
+        }
+
+        if (std::abs(e) >= tol1 && std::abs(fa) > std::abs(fb)) {
+            // Attempt inverse quadratic interpolation, or a secant step if
+            // only two distinct points are available
+            double p, q;
+            double const s = fb / fa;
+            if (a == c) {
+                p = 2.0 * xm * s;
+                q = 1.0 - s;
+            } else {
+                double const qa = fa / fc;
+                double const r = fb / fc;
+                p = s * (2.0 * xm * qa * (qa - r) - (b - a) * (r - 1.0));
+                q = (qa - 1.0) * (r - 1.0) * (s - 1.0);
+            }
+
+            if (p > 0.0) {
+                q = -q;
+            }
+            p = std::abs(p);
+
+            double const min1 = 3.0 * xm * q - std::abs(tol1 * q);
+            double const min2 = std::abs(e * q);
+
+            if (2.0 * p < std::min(min1, min2)) {
+                // Accept the interpolation
+                e = d;
+                d = p / q;
+            } else {
+                // Interpolation failed; use bisection
+                d = xm;
+                e = d;
+            }
+        } else {
+            // Bounds are decreasing too slowly; use bisection
+            d = xm;
+            e = d;
+        }
+
+        a = b;
+        fa = fb;
+
+        b += std::abs(d) > tol1 ? d : std::copysign(tol1, xm);
+        fb = F(b);
+        ++evaluations;
+    }
+
+    return b;
+}
+
+/**
+ * @brief Solves `F(Ci) = 0` for the intercellular CO2 concentration using
+ * Brent's method.
+ *
+ * At `Ci = 0`, the net assimilation rate is negative and `F` is positive. A
+ * sign change is first sought at `Ci = Ca`; when the net assimilation rate is
+ * negative there as well (for example, in darkness), the upper end of the
+ * bracket is repeatedly doubled.
+ *
+ * If a guess for Ci is provided, such as the solution for similar conditions,
+ * a narrow bracket around the guess is tried first. When the root lies outside
+ * of it, the residuals at its edges are reused as one end of the usual
+ * bracket.
+ *
+ * @param [in] F The residual function; must accept and return values in
+ *             micromol / mol.
+ *
+ * @param [in] Ca The atmospheric CO2 concentration in micromol / mol.
+ *
+ * @param [out] Ci The root of `F` in micromol / mol.
+ *
+ * @param [out] evaluations The number of times `F` was evaluated.
+ *
+ * @param [in] Ci_guess An optional guess for Ci in micromol / mol.
+ *
+ * @return `true` if a root was bracketed and located, or `false` otherwise, in
+ *         which case the caller should fall back to the fixed point iteration.
+ */
+template <typename residual_function>
+bool solve_ci_brent(
+    residual_function const& F,
+    double const Ca,
+    double& Ci,
+    int& evaluations,
+    double const* Ci_guess = nullptr)
+{
+    evaluations = 0;
+
+    double lower = 0.0;  // micromol / mol
+    double upper = Ca;   // micromol / mol
+    double f_lower{};
+    double f_upper{};
+    bool lower_known = false;
+    bool upper_known = false;
+
+    if (Ci_guess) {
+        double const lo = std::max(*Ci_guess - ci_solver_warm_start_width, 0.0);  // micromol / mol
+        double const hi = lo + 2.0 * ci_solver_warm_start_width;                 // micromol / mol
+        double const f_lo = F(lo);
+        double const f_hi = F(hi);
+        evaluations += 2;
+
+        if (f_lo >= 0.0 && f_hi <= 0.0) {
+            Ci = brent_root(
+                F, lo, hi, f_lo, f_hi, ci_solver_tolerance,
+                ci_solver_max_iterations, evaluations);
+
+            return true;
+        } else if (f_hi > 0.0) {
+            // The root is above the narrow bracket
+            lower = hi;
+            f_lower = f_hi;
+            lower_known = true;
+            upper = std::max(Ca, 2.0 * hi);
+        } else if (f_lo < 0.0) {
+            // The root is below the narrow bracket
+            upper = lo;
+            f_upper = f_lo;
+            upper_known = true;
+        }
+    }
+
+    if (!lower_known) {
+        f_lower = F(lower);
+        ++evaluations;
+    }
+
+    if (!upper_known) {
+        f_upper = F(upper);
+        ++evaluations;
+    }
+
+    int expansions = 0;
+    while (f_upper > 0.0 && f_lower > 0.0 &&
+           expansions < ci_solver_max_bracket_expansions) {
+        lower = upper;
+        f_lower = f_upper;
+        upper *= 2.0;
+        f_upper = F(upper);
+        ++evaluations;
+        ++expansions;
+    }
+
+    // A NaN residual will also fail this check
+    if (!(f_lower >= 0.0 && f_upper <= 0.0)) {
+        return false;
+    }
+
+    Ci = brent_root(
+        F, lower, upper, f_lower, f_upper, ci_solver_tolerance,
+        ci_solver_max_iterations, evaluations);
+
+    return true;
+}
+
+#endif
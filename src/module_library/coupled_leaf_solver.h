@@ -0,0 +1,146 @@
+#ifndef COUPLED_LEAF_SOLVER_H
+#define COUPLED_LEAF_SOLVER_H
+
+#include <cmath>                     // for std::abs
+#include "photosynthesis_outputs.h"  // for photosynthesis_outputs
+#include "leaf_energy_balance.h"     // for energy_balance_outputs
+#include "ci_solver.h"               // for ci_solver_method
+#include "leaf_solver_statistics.h"  // for record_leaf_solver_call, leaf_solver
+
+/**
+ * @brief Methods for finding a leaf's photosynthesis rate, stomatal
+ * conductance, and temperature, which depend on each other through the leaf
+ * energy balance.
+ *
+ * - `two_pass`: The original approach used by the leaf photosynthesis modules.
+ *   Stomatal conductance is first estimated with the leaf at air temperature
+ *   using a guess for the boundary layer conductance. This conductance is used
+ *   to calculate the leaf temperature from the energy balance, and then the
+ *   photosynthesis calculation is repeated at the new leaf temperature. The
+ *   final stomatal conductance is generally not the one used to find the leaf
+ *   temperature.
+ *
+ * - `coupled`: The energy balance and photosynthesis calculations are
+ *   alternated until the leaf temperature stops changing, so the final
+ *   stomatal conductance, leaf temperature, and transpiration rate are
+ *   consistent with each other. Ci is found using Brent's method (see
+ *   `ci_solver_method`), which reliably converges in cases where the fixed
+ *   point iteration does not. After the first calculation, each photosynthesis
+ *   calculation starts by searching for Ci in a narrow range around the
+ *   previous solution, so it usually needs only a few evaluations. In total,
+ *   this typically requires fewer iterations than the two-pass method, even
+ *   though more photosynthesis calculations are performed.
+ */
+enum class leaf_solver_method {
+    two_pass,
+    coupled
+};
+
+double constexpr coupled_leaf_tolerance = 1e-3;  // degrees C
+int constexpr coupled_leaf_max_iterations = 20;
+
+struct coupled_leaf_outputs {
+    photosynthesis_outputs photo;
+    energy_balance_outputs et;
+    double leaf_temperature;  // degrees C
+    int iterations;           // not a physical quantity
+};
+
+/**
+ * @brief Calculates leaf photosynthesis and energy balance using one of the
+ * methods described in `leaf_solver_method`.
+ *
+ * @param [in] photosynthesis A function with signature
+ *             `photosynthesis_outputs(double Tleaf, double gbw,
+ *             ci_solver_method ci_solver,
+ *             photosynthesis_outputs const* initial_guess)`, where `Tleaf` is
+ *             the leaf temperature in degrees C and `gbw` is the boundary layer
+ *             conductance in mol / m^2 / s. It is expected to pass `ci_solver`
+ *             and `initial_guess` along to `c3photoC()` or `c4photoC()`.
+ *
+ * @param [in] energy_balance A function with signature
+ *             `energy_balance_outputs(double Gs)`, where `Gs` is the stomatal
+ *             conductance in mol / m^2 / s.
+ *
+ * @param [in] ambient_temperature The air temperature in degrees C.
+ *
+ * @param [in] gbw_guess The boundary layer conductance in mol / m^2 / s used
+ *             for the first photosynthesis calculation.
+ *
+ * @param [in] method The solution method.
+ *
+ * For the coupled method, each pass of the loop calculates photosynthesis at
+ * the current leaf temperature and then updates the leaf temperature from the
+ * energy balance, so the returned photosynthesis outputs were calculated at the
+ * leaf temperature from the previous pass. When the loop converges, this
+ * differs from the returned leaf temperature by less than
+ * `coupled_leaf_tolerance`; the photosynthesis outputs are not recalculated,
+ * so that the returned stomatal conductance is the one used in the final
+ * energy balance. The number of passes is recorded with
+ * `record_leaf_solver_call()`, and a call that reaches
+ * `coupled_leaf_max_iterations` passes without converging is counted as not
+ * converged.
+ *
+ * @return The photosynthesis and energy balance outputs, along with the leaf
+ *         temperature and the total number of photosynthesis iterations
+ *         summed over all of the photosynthesis calculations. For the coupled
+ *         method, the number of iterations for each photosynthesis calculation
+ *         is the number of residual evaluations used by Brent's method.
+ */
+template <typename photosynthesis_function, typename energy_balance_function>
+coupled_leaf_outputs solve_leaf_photosynthesis(
+    photosynthesis_function const& photosynthesis,
+    energy_balance_function const& energy_balance,
+    double const ambient_temperature,  // degrees C
+    double const gbw_guess,            // mol / m^2 / s
+    leaf_solver_method const method)
+{
+    ci_solver_method const ci_solver =
+        method == leaf_solver_method::coupled ? ci_solver_method::brent
+                                              : ci_solver_method::fixed_point;
+
+    // Get an initial estimate of stomatal conductance, assuming the leaf is at
+    // air temperature
+    photosynthesis_outputs photo =
+        photosynthesis(ambient_temperature, gbw_guess, ci_solver, nullptr);
+
+    int iterations = photo.iterations;
+
+    // Calculate a new value for leaf temperature
+    energy_balance_outputs et = energy_balance(photo.Gs);
+
+    double leaf_temperature = ambient_temperature + et.Deltat;  // degrees C
+
+    if (method == leaf_solver_method::two_pass) {
+        // Calculate final values for assimilation, stomatal conductance, and
+        // Ci using the new leaf temperature
+        photo = photosynthesis(leaf_temperature, et.gbw_molecular, ci_solver, nullptr);
+        iterations += photo.iterations;
+
+        return coupled_leaf_outputs{photo, et, leaf_temperature, iterations};
+    }
+
+    int passes = 0;
+    bool converged = false;
+    while (!converged && passes < coupled_leaf_max_iterations) {
+        // Update photosynthesis at the current leaf temperature, starting from
+        // the previous solution
+        photo = photosynthesis(leaf_temperature, et.gbw_molecular, ci_solver, &photo);
+        iterations += photo.iterations;
+
+        // Update the leaf temperature using the new stomatal conductance
+        et = energy_balance(photo.Gs);
+
+        double const previous_leaf_temperature = leaf_temperature;  // degrees C
+        leaf_temperature = ambient_temperature + et.Deltat;         // degrees C
+
+        converged = std::abs(leaf_temperature - previous_leaf_temperature) < coupled_leaf_tolerance;
+        ++passes;
+    }
+
+    record_leaf_solver_call(leaf_solver::coupled_leaf_temperature, passes, converged);
+
+    return coupled_leaf_outputs{photo, et, leaf_temperature, iterations};
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include <atomic>   // for std::atomic
+#include <cstddef>  // for size_t
+#include <cstdlib>  // for std::malloc, std::free
+#include <new>      // for std::bad_alloc
+#include "heap_allocation_counter.h"
+
+namespace
+{
+std::atomic<unsigned long> heap_allocations{0};
+}  // namespace
+
+#ifdef BIOCRO_COUNT_HEAP_ALLOCATIONS
+
+// The other forms of `operator new` and `operator delete`, including the
+// array, nothrow, and sized forms, call these by default
+void* operator new(size_t size)
+{
+    ++heap_allocations;
+
+    void* const p = std::malloc(size > 0 ? size : 1);
+
+    if (!p) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+#endif
+
+bool heap_allocation_counting_enabled()
+{
+#ifdef BIOCRO_COUNT_HEAP_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+unsigned long get_heap_allocation_count()
+{
+    return heap_allocations;
+}
+
+void reset_heap_allocation_count()
+{
+    heap_allocations = 0;
+}
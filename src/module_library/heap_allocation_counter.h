@@ -0,0 +1,23 @@
+#ifndef HEAP_ALLOCATION_COUNTER_H
+#define HEAP_ALLOCATION_COUNTER_H
+
+/**
+ * @brief Functions for counting the number of times memory is allocated using
+ * `operator new`, which is how standard library containers such as
+ * `std::vector` obtain their memory.
+ *
+ * Counting requires replacing the global `operator new`, so it is only
+ * available when BioCro is compiled with the `BIOCRO_COUNT_HEAP_ALLOCATIONS`
+ * preprocessor macro defined; for example, by adding
+ * `-DBIOCRO_COUNT_HEAP_ALLOCATIONS` to `PKG_CPPFLAGS` in `src/Makevars`. This
+ * is intended for debugging and performance investigations only. Otherwise,
+ * `heap_allocation_counting_enabled()` returns `false` and the count is always
+ * zero.
+ */
+bool heap_allocation_counting_enabled();
+
+unsigned long get_heap_allocation_count();
+
+void reset_heap_allocation_count();
+
+#endif
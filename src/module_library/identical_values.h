@@ -0,0 +1,21 @@
+#ifndef IDENTICAL_VALUES_H
+#define IDENTICAL_VALUES_H
+
+#include <cstring>  // for std::memcmp
+
+/**
+ *  @brief Determines whether two values have exactly the same binary
+ *  representation.
+ *
+ *  This is stricter than `a == b`: `0.0` and `-0.0` are not considered to be
+ *  identical, while two NaNs with the same representation are. It is intended
+ *  for situations where a calculation is skipped because its inputs match
+ *  those of a previous calculation, so that the skipped calculation would have
+ *  produced exactly the same results.
+ */
+inline bool identical_values(double a, double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+#endif
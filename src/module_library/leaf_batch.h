@@ -0,0 +1,124 @@
+#ifndef LEAF_BATCH_H
+#define LEAF_BATCH_H
+
+#include <string>                    // for std::string
+#include <type_traits>               // for std::false_type, std::true_type, std::is_same
+#include <memory>                    // for std::unique_ptr
+#include <vector>                    // for std::vector
+#include "../framework/module.h"     // for quantity_access_error
+#include "../framework/state_map.h"  // for state_vector_map
+
+/**
+ * @class leaf_batch
+ *
+ * @brief A base class for batched versions of leaf photosynthesis modules.
+ *
+ * A leaf batch performs the same calculations as its corresponding leaf module,
+ * but for many leaves at once. Its input and output quantities are stored as a
+ * structure of arrays in `state_vector_map` objects, where element `i` of each
+ * vector holds the value of that quantity for leaf `i`. The number of leaves is
+ * determined by the length of the input vectors, which may change between calls
+ * to `run()`. Every input and output vector must have the same length.
+ *
+ * A leaf module `leaf_module_type` indicates that it has a batched version by
+ * declaring a public type alias `leaf_module_type::batch_type`, where
+ * `batch_type` is derived from `leaf_batch`, has a constructor accepting a
+ * `state_vector_map const&` of inputs and a `state_vector_map*` of outputs, and
+ * declares `batch_type::module_type` to be `leaf_module_type`. The last
+ * requirement prevents modules derived from a leaf module (which may perform
+ * different calculations) from inheriting its batched version.
+ *
+ * A batched version must produce exactly the same outputs as running the leaf
+ * module for each leaf individually.
+ */
+class leaf_batch
+{
+   public:
+    virtual ~leaf_batch() {}
+    void run() const { do_operation(); }
+
+   private:
+    virtual void do_operation() const = 0;
+};
+
+/**
+ * @brief Returns a reference to the vector of values for a named quantity in a
+ * `state_vector_map`, throwing an exception if the quantity is not defined.
+ */
+inline std::vector<double> const& get_batch_input(
+    state_vector_map const& input_quantities,
+    std::string const& name)
+{
+    auto const it = input_quantities.find(name);
+    if (it == input_quantities.end()) {
+        throw quantity_access_error(
+            "Thrown by get_batch_input: the quantity '" + name +
+            "' was not defined in the state_vector_map.");
+    }
+    return it->second;
+}
+
+/**
+ * @brief Returns a pointer to the vector of values for a named quantity in a
+ * `state_vector_map`, throwing an exception if the quantity is not defined.
+ */
+inline std::vector<double>* get_batch_op(
+    state_vector_map* output_quantities,
+    std::string const& name)
+{
+    auto const it = output_quantities->find(name);
+    if (it == output_quantities->end()) {
+        throw quantity_access_error(
+            "Thrown by get_batch_op: the quantity '" + name +
+            "' was not defined in the state_vector_map.");
+    }
+    return &(it->second);
+}
+
+/**
+ * @brief Determines whether `leaf_module_type` has a batched version, as
+ * described in `leaf_batch`.
+ */
+template <typename leaf_module_type, typename = void>
+struct has_leaf_batch : std::false_type {
+};
+
+template <typename leaf_module_type>
+struct has_leaf_batch<
+    leaf_module_type,
+    typename std::enable_if<
+        std::is_same<
+            typename leaf_module_type::batch_type::module_type,
+            leaf_module_type>::value>::type> : std::true_type {
+};
+
+/**
+ * @brief Creates the batched version of `leaf_module_type`, or returns a null
+ * pointer if it does not have one.
+ */
+template <typename leaf_module_type>
+typename std::enable_if<
+    has_leaf_batch<leaf_module_type>::value,
+    std::unique_ptr<leaf_batch>>::type
+make_leaf_batch(
+    state_vector_map const& input_quantities,
+    state_vector_map* output_quantities)
+{
+    return std::unique_ptr<leaf_batch>(
+        new typename leaf_module_type::batch_type(
+            input_quantities,
+            output_quantities));
+}
+
+template <typename leaf_module_type>
+typename std::enable_if<
+    !has_leaf_batch<leaf_module_type>::value,
+    std::unique_ptr<leaf_batch>>::type
+make_leaf_batch(
+    state_vector_map const&,
+    state_vector_map*)
+{
+    return std::unique_ptr<leaf_batch>();
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include <algorithm>  // for std::min, std::max
+#include <atomic>     // for std::atomic
+#include "leaf_solver_statistics.h"
+
+namespace
+{
+size_t constexpr n_solvers = 6;
+
+char const* const solver_names[n_solvers] = {
+    "c3photoC",
+    "c3photoC_brent",
+    "c4photoC",
+    "c4photoC_brent",
+    "leaf_boundary_layer_conductance_nikolov",
+    "coupled_leaf_temperature"};
+
+// Recording is disabled by default, so the only cost of each call to
+// `record_leaf_solver_call()` is a check of this flag
+std::atomic<bool> enabled{false};
+
+std::atomic<unsigned long> histograms[n_solvers][leaf_solver_histogram_bins];
+std::atomic<unsigned long> not_converged[n_solvers];
+}  // namespace
+
+void set_leaf_solver_statistics_enabled(bool enable)
+{
+    enabled = enable;
+}
+
+bool leaf_solver_statistics_enabled()
+{
+    return enabled;
+}
+
+/**
+ * @brief Adds one call of a leaf solver to its iteration histogram, if
+ * recording is enabled.
+ *
+ * The counters are shared by all threads; they are updated with relaxed
+ * atomic operations, since only their final values are of interest.
+ */
+void record_leaf_solver_call(leaf_solver solver, int iterations, bool converged)
+{
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    size_t const s = static_cast<size_t>(solver);
+    size_t const bin = std::min(
+        static_cast<size_t>(std::max(iterations, 0)),
+        leaf_solver_histogram_bins - 1);
+
+    histograms[s][bin].fetch_add(1, std::memory_order_relaxed);
+
+    if (!converged) {
+        not_converged[s].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<leaf_solver_statistics> get_leaf_solver_statistics()
+{
+    std::vector<leaf_solver_statistics> result;
+
+    for (size_t s = 0; s < n_solvers; ++s) {
+        leaf_solver_statistics stats{solver_names[s], {}, not_converged[s]};
+        for (size_t b = 0; b < leaf_solver_histogram_bins; ++b) {
+            stats.iteration_histogram.push_back(histograms[s][b]);
+        }
+        result.push_back(stats);
+    }
+
+    return result;
+}
+
+void reset_leaf_solver_statistics()
+{
+    for (size_t s = 0; s < n_solvers; ++s) {
+        for (size_t b = 0; b < leaf_solver_histogram_bins; ++b) {
+            histograms[s][b] = 0;
+        }
+        not_converged[s] = 0;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef LEAF_SOLVER_STATISTICS_H
+#define LEAF_SOLVER_STATISTICS_H
+
+#include <cstddef>  // for size_t
+#include <string>
+#include <vector>
+
+/**
+ * @brief The iterative leaf-level calculations whose iteration counts can be
+ * recorded by `record_leaf_solver_call()`.
+ */
+enum class leaf_solver {
+    c3photoC,                                 // fixed point loop in `c3photoC()`
+    c3photoC_brent,                           // Brent's method in `c3photoC()`
+    c4photoC,                                 // fixed point loop in `c4photoC()`
+    c4photoC_brent,                           // Brent's method in `c4photoC()`
+    leaf_boundary_layer_conductance_nikolov,  // free convection loop
+    coupled_leaf_temperature,                 // leaf temperature loop in `solve_leaf_photosynthesis()`
+};
+
+/**
+ * @brief The number of bins in each iteration histogram. Bin `i` counts the
+ * calls that required `i` iterations, except for the last bin, which counts
+ * all calls that required at least `leaf_solver_histogram_bins - 1`.
+ */
+size_t constexpr leaf_solver_histogram_bins = 64;
+
+/**
+ * @brief The iteration counts recorded for one leaf solver.
+ *
+ * A call is counted as not converged if its iteration limit was reached (for
+ * the fixed point loop in `c3photoC()` and the loop in
+ * `leaf_boundary_layer_conductance_nikolov()` and the coupled leaf temperature
+ * loop in `solve_leaf_photosynthesis()`), if the stomatal conductance
+ * had to be reset to `bb0` to force convergence (for the fixed point loop in
+ * `c4photoC()`), or if a solution could not be bracketed (for Brent's method).
+ */
+struct leaf_solver_statistics {
+    std::string name;
+    std::vector<unsigned long> iteration_histogram;
+    unsigned long not_converged;
+};
+
+void set_leaf_solver_statistics_enabled(bool enable);
+
+bool leaf_solver_statistics_enabled();
+
+void record_leaf_solver_call(leaf_solver solver, int iterations, bool converged);
+
+std::vector<leaf_solver_statistics> get_leaf_solver_statistics();
+
+void reset_leaf_solver_statistics();
+
+#endif
@@ -1,5 +1,6 @@
 #include "module_library.h"
 #include "../framework/module_creator.h"  // for create_mc
+#include "multilayer_module_creator.h"    // for create_multilayer_mc, retrieve_multilayer_module
 
 // When creating a new module library R package, it will be necessary to modify
 // the namespace in this file to match the one defined in `module_library.h`.
@@ -105,12 +106,16 @@ creator_map standardBML::module_library::library_entries =
      {"buck_swvp",                                             &create_mc<buck_swvp>},
      {"bucket_soil_drainage",                                  &create_mc<bucket_soil_drainage>},
      {"c3_assimilation",                                       &create_mc<c3_assimilation>},
+     {"c3_assimilation_brent",                                 &create_mc<c3_assimilation_brent>},
      {"c3_canopy",                                             &create_mc<c3_canopy>},
      {"c3_leaf_photosynthesis",                                &create_mc<c3_leaf_photosynthesis>},
+     {"c3_leaf_photosynthesis_coupled",                        &create_mc<c3_leaf_photosynthesis_coupled>},
      {"c3_parameters",                                         &create_mc<c3_parameters>},
      {"c4_assimilation",                                       &create_mc<c4_assimilation>},
+     {"c4_assimilation_brent",                                 &create_mc<c4_assimilation_brent>},
      {"c4_canopy",                                             &create_mc<c4_canopy>},
      {"c4_leaf_photosynthesis",                                &create_mc<c4_leaf_photosynthesis>},
+     {"c4_leaf_photosynthesis_coupled",                        &create_mc<c4_leaf_photosynthesis_coupled>},
      {"carbon_assimilation_to_biomass",                        &create_mc<carbon_assimilation_to_biomass>},
      {"canopy_gbw_thornley",                                   &create_mc<canopy_gbw_thornley>},
      {"development_index",                                     &create_mc<development_index>},
@@ -192,3 +197,17 @@ creator_map standardBML::module_library::library_entries =
      {"varying_Jmax25",                                        &create_mc<varying_Jmax25>},
      {"water_vapor_properties_from_air_temperature",           &create_mc<water_vapor_properties_from_air_temperature>}
 };
+
+multilayer_creator_map standardBML::module_library::multilayer_entries =
+{
+     {"c3_canopy",                                             &create_multilayer_mc<n_layer_c3_canopy>},
+     {"c4_canopy",                                             &create_multilayer_mc<n_layer_c4_canopy>},
+     {"canopy_integrator",                                     &create_multilayer_mc<n_layer_canopy_integrator>},
+     {"canopy_properties",                                     &create_multilayer_mc<n_layer_canopy_properties>},
+     {"rue_canopy",                                            &create_multilayer_mc<n_layer_rue_canopy>}
+};
+
+module_creator* standardBML::module_library::retrieve_multilayer(std::string const& module_name)
+{
+    return retrieve_multilayer_module(multilayer_entries, module_name);
+}
@@ -1,7 +1,9 @@
 #ifndef STANDARDBML_H
 #define STANDARDBML_H
 
+#include <string>
 #include "../framework/module_creator.h"  // for module_creator and creator_map
+#include "multilayer_module_creator.h"    // for multilayer_creator_map
 
 // When creating a new module library R package, it will be necessary to modify
 // the header guard and the namespace name in this file to reflect the new
@@ -20,6 +22,11 @@ class module_library
 {
    public:
     static creator_map library_entries;
+
+    // Multilayer modules whose number of layers is included in the module
+    // name, such as `30_layer_c3_canopy`; see `retrieve_multilayer_module()`
+    static multilayer_creator_map multilayer_entries;
+    static module_creator* retrieve_multilayer(std::string const& module_name);
 };
 
 }  // namespace standardBML
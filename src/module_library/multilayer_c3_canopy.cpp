@@ -1,5 +1,6 @@
 #include "multilayer_c3_canopy.h"
 
+using standardBML::n_layer_c3_canopy;
 using standardBML::ten_layer_c3_canopy;
 using standardBML::ten_layer_c3_canopy_parent;
 
@@ -26,3 +27,18 @@ void ten_layer_c3_canopy::do_operation() const
     // Just call the parent class's run operation
     ten_layer_c3_canopy_parent::run();
 }
+
+string_vector n_layer_c3_canopy::get_inputs(int nlayers)
+{
+    return ten_layer_c3_canopy_parent::generate_inputs(nlayers);
+}
+
+string_vector n_layer_c3_canopy::get_outputs(int nlayers)
+{
+    return ten_layer_c3_canopy_parent::generate_outputs(nlayers);
+}
+
+void n_layer_c3_canopy::do_operation() const
+{
+    ten_layer_c3_canopy_parent::run();
+}
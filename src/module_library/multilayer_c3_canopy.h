@@ -56,5 +56,34 @@ class ten_layer_c3_canopy : public ten_layer_c3_canopy_parent
     void do_operation() const;
 };
 
+/**
+ * @class n_layer_c3_canopy
+ *
+ * @brief Identical to `ten_layer_c3_canopy`, except that the number of layers
+ * is specified when the module is created. Instances of this class can be
+ * created using a `multilayer_module_creator`, which is retrieved using a name
+ * such as `30_layer_c3_canopy`.
+ */
+class n_layer_c3_canopy : public ten_layer_c3_canopy_parent
+{
+   public:
+    n_layer_c3_canopy(
+        int const& nlayers,
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : ten_layer_c3_canopy_parent(
+              nlayers,
+              input_quantities,
+              output_quantities)
+    {
+    }
+    static string_vector get_inputs(int nlayers);
+    static string_vector get_outputs(int nlayers);
+
+   private:
+    // Main operation
+    void do_operation() const;
+};
+
 }  // namespace standardBML
 #endif
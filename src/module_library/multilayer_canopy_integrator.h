@@ -266,5 +266,41 @@ void ten_layer_canopy_integrator::do_operation() const
     multilayer_canopy_integrator::run();
 }
 
+//////////////////////////////////////
+// N LAYER CANOPY INTEGRATOR MODULE //
+//////////////////////////////////////
+
+/**
+ * @class n_layer_canopy_integrator
+ *
+ * @brief A child class of multilayer_canopy_integrator where the number of
+ * layers is specified when the module is created. Instances of this class can
+ * be created using a `multilayer_module_creator`, which is retrieved using a
+ * name such as `30_layer_canopy_integrator`.
+ */
+class n_layer_canopy_integrator : public multilayer_canopy_integrator
+{
+   public:
+    n_layer_canopy_integrator(
+        int const& nlayers,
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : multilayer_canopy_integrator(
+              nlayers,
+              input_quantities,
+              output_quantities)
+    {
+    }
+
+   private:
+    // Main operation
+    void do_operation() const;
+};
+
+void n_layer_canopy_integrator::do_operation() const
+{
+    multilayer_canopy_integrator::run();
+}
+
 }  // namespace standardBML
 #endif
@@ -2,8 +2,12 @@
 #define MULTILAYER_CANOPY_PHOTOSYNTHESIS_H
 
 #include <algorithm>  // for std::find
+#include <memory>     // for std::unique_ptr
+#include <vector>
 #include "../framework/module.h"
 #include "../framework/state_map.h"
+#include "identical_values.h"  // for identical_values
+#include "leaf_batch.h"        // for leaf_batch, has_leaf_batch, make_leaf_batch
 
 namespace MLCP  // helping functions for the MultiLayer Canopy Photosynthesis module
 {
@@ -148,6 +152,16 @@ namespace standardBML
  * base name (e.g. `incident_par`), a prefix that indicates the leaf class (e.g.
  * `sunlit_`), and a suffix that indicates the layer number (e.g. `_layer_0`).
  *
+ * ### Batched leaf modules
+ *
+ * If the leaf module has a batched version (see `leaf_batch`), it is used in
+ * place of the leaf module. In that case, the inputs for all leaves are
+ * gathered into vectors, the outputs for all leaves are calculated with a
+ * single call to the batched module, and then the outputs are distributed to
+ * the individual layers and leaf classes. Otherwise, the leaf module is run
+ * separately for each leaf. In either case, leaves whose inputs are identical
+ * to those of the previous leaf are not recalculated.
+ *
  * Note that this module has a non-standard constructor, so it cannot be created
  * using the module_factory. Rather, it is expected that directly-usable
  * classes will be derived from this class.
@@ -170,11 +184,42 @@ class multilayer_canopy_photosynthesis : public direct_module
     state_map leaf_module_output_map;
     std::unique_ptr<module> leaf_module;
 
-    // Pointers to input parameters
-    std::vector<std::vector<std::pair<double*, const double*>>> leaf_input_ptr_pairs;
+    // Batched version of the leaf photosynthesis module, which is used instead
+    // of `leaf_module` when it is available
+    state_vector_map leaf_batch_inputs;
+    state_vector_map leaf_batch_outputs;
+    std::unique_ptr<leaf_batch> leaf_module_batch;
+
+    // Number of leaf class and layer combinations
+    size_t nleaves;
+
+    // Pointers to input parameters that do not change with leaf class or
+    // layer; these only need to be copied once per call to `run()`
+    std::vector<std::pair<double*, const double*>> shared_input_ptr_pairs;
+
+    // Pointers to input parameters that change with leaf class or layer,
+    // stored contiguously with `n_leaf_inputs` pairs for each leaf
+    size_t n_leaf_inputs;
+    std::vector<std::pair<double*, const double*>> leaf_input_ptr_pairs;
+
+    // Pointers to output parameters, stored contiguously with
+    // `n_leaf_outputs` pairs for each leaf
+    size_t n_leaf_outputs;
+    std::vector<std::pair<double*, const double*>> leaf_output_ptr_pairs;
+
+    // Pointers to the batch input vectors for quantities that do not change
+    // with leaf class or layer, paired with pointers to their values
+    std::vector<std::pair<std::vector<double>*, const double*>> shared_batch_input_ptr_pairs;
+
+    // Pointers to the batch input and output vectors, in the same order as
+    // the pointer pairs for a single leaf
+    std::vector<std::vector<double>*> leaf_batch_input_ptrs;
+    std::vector<std::vector<double>*> leaf_batch_output_ptrs;
+
+    // The position in the batch used for each leaf
+    mutable std::vector<size_t> leaf_slot;
 
-    // Pointers to output parameters
-    std::vector<std::vector<std::pair<double*, const double*>>> leaf_output_ptr_pairs;
+    void run_batch() const;
 
    protected:
     static string_vector generate_inputs(int nlayers);
@@ -193,7 +238,8 @@ multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::multilay
     state_map const& input_quantities,
     state_map* output_quantities)
     : direct_module{},
-      nlayers(nlayers)
+      nlayers(nlayers),
+      nleaves(canopy_module_type::define_leaf_classes().size() * nlayers)
 {
     // Define a lambda for making quantity maps from vectors of inputs and outputs
     auto make_quantity_map = [](string_vector input_names, string_vector output_names) -> state_map {
@@ -214,11 +260,28 @@ multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::multilay
 
     leaf_module_output_map = leaf_module_quantities;
 
-    // Create the leaf photosynthesis module
-    leaf_module =
-        std::unique_ptr<module>(new leaf_module_type(
-            leaf_module_quantities,
-            &leaf_module_output_map));
+    // Create the leaf photosynthesis module, or its batched version if there
+    // is one
+    if (has_leaf_batch<leaf_module_type>::value) {
+        for (std::string const& name : leaf_module_type::get_inputs()) {
+            leaf_batch_inputs[name] = std::vector<double>(nleaves);
+        }
+
+        for (std::string const& name : leaf_module_type::get_outputs()) {
+            leaf_batch_outputs[name] = std::vector<double>(nleaves);
+        }
+
+        leaf_module_batch = make_leaf_batch<leaf_module_type>(
+            leaf_batch_inputs,
+            &leaf_batch_outputs);
+
+        leaf_slot.resize(nleaves);
+    } else {
+        leaf_module =
+            std::unique_ptr<module>(new leaf_module_type(
+                leaf_module_quantities,
+                &leaf_module_output_map));
+    }
 
     // Find subsets of the leaf model's inputs
     string_vector multiclass_multilayer_leaf_inputs =
@@ -230,64 +293,80 @@ multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::multilay
     string_vector other_leaf_inputs =
         MLCP::get_other_leaf_inputs<canopy_module_type, leaf_module_type>();
 
-    // Create vectors of pointer pairs which will be used for passing inputs to
-    // and getting outputs from the leaf module
-    for (std::string const& class_name : canopy_module_type::define_leaf_classes()) {
-        for (int i = 0; i < nlayers; ++i) {
-            // Get pointer pairs for the leaf module inputs and store them
-            std::vector<std::pair<double*, const double*>> input_ptr_pairs;
+    // Get pointer pairs for the leaf module inputs that do not change with leaf
+    // class or layer
+    for (std::string const& name : other_leaf_inputs) {
+        shared_input_ptr_pairs.emplace_back(
+            get_op(&leaf_module_quantities, name),
+            get_ip(input_quantities, name));
+    }
+
+    string_vector const leaf_outputs = leaf_module_type::get_outputs();
+
+    n_leaf_inputs = multiclass_multilayer_leaf_inputs.size() + multilayer_leaf_inputs.size();
+    n_leaf_outputs = leaf_outputs.size();
+
+    leaf_input_ptr_pairs.reserve(nleaves * n_leaf_inputs);
+    leaf_output_ptr_pairs.reserve(nleaves * n_leaf_outputs);
+
+    // Get pointers to the batch input and output vectors
+    if (leaf_module_batch) {
+        for (std::string const& name : other_leaf_inputs) {
+            shared_batch_input_ptr_pairs.emplace_back(
+                get_batch_op(&leaf_batch_inputs, name),
+                get_ip(input_quantities, name));
+        }
+
+        for (string_vector const& sv : {multiclass_multilayer_leaf_inputs, multilayer_leaf_inputs}) {
+            for (std::string const& name : sv) {
+                leaf_batch_input_ptrs.push_back(get_batch_op(&leaf_batch_inputs, name));
+            }
+        }
 
+        for (std::string const& name : leaf_outputs) {
+            leaf_batch_output_ptrs.push_back(get_batch_op(&leaf_batch_outputs, name));
+        }
+    }
+
+    // Fill contiguous vectors of pointer pairs which will be used for passing
+    // inputs to and getting outputs from the leaf module; the pairs for each
+    // leaf are stored next to each other so they can be traversed in order.
+    // The leaves in each layer are stored next to each other so that `run()`
+    // can recognize leaves whose inputs match those of the previous leaf.
+    for (int i = 0; i < nlayers; ++i) {
+        for (std::string const& class_name : canopy_module_type::define_leaf_classes()) {
+            // Get pointer pairs for the leaf module inputs and store them
             for (std::string const& name : multiclass_multilayer_leaf_inputs) {
                 std::string specific_name =
                     add_class_prefix_to_quantity_name(
                         class_name,
                         add_layer_suffix_to_quantity_name(nlayers, i, name));
 
-                std::pair<double*, const double*> temporary(
+                leaf_input_ptr_pairs.emplace_back(
                     get_op(&leaf_module_quantities, name),
                     get_ip(input_quantities, specific_name));
-
-                input_ptr_pairs.push_back(temporary);
             }
 
             for (std::string const& name : multilayer_leaf_inputs) {
                 std::string specific_name =
                     add_layer_suffix_to_quantity_name(nlayers, i, name);
 
-                std::pair<double*, const double*> temporary(
+                leaf_input_ptr_pairs.emplace_back(
                     get_op(&leaf_module_quantities, name),
                     get_ip(input_quantities, specific_name));
-
-                input_ptr_pairs.push_back(temporary);
-            }
-
-            for (std::string const& name : other_leaf_inputs) {
-                std::pair<double*, const double*> temporary(
-                    get_op(&leaf_module_quantities, name),
-                    get_ip(input_quantities, name));
-
-                input_ptr_pairs.push_back(temporary);
             }
 
-            leaf_input_ptr_pairs.push_back(input_ptr_pairs);
-
             // Get pointer pairs to the leaf module outputs and store them
-            std::vector<std::pair<double*, const double*>> output_ptr_pairs;
-
-            for (std::string const& name : leaf_module_type::get_outputs()) {
+            for (std::string const& name : leaf_outputs) {
                 std::string specific_name =
                     add_class_prefix_to_quantity_name(
                         class_name,
                         add_layer_suffix_to_quantity_name(nlayers, i, name));
 
-                std::pair<double*, const double*> temporary(
+                leaf_output_ptr_pairs.emplace_back(
                     get_op(output_quantities, specific_name),
                     get_ip(leaf_module_output_map, name));
-
-                output_ptr_pairs.push_back(temporary);
             }
-
-            leaf_output_ptr_pairs.push_back(output_ptr_pairs);
         }
     }
 }
@@ -337,19 +416,101 @@ string_vector multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_t
 template <typename canopy_module_type, typename leaf_module_type>
 void multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::run() const
 {
-    // For each combination of leaf class and layer number:
-    for (size_t i = 0; i < leaf_input_ptr_pairs.size(); ++i) {
-        // Update the inputs to the leaf module
-        for (auto const& x : leaf_input_ptr_pairs[i]) {
-            *x.first = *x.second;
+    if (leaf_module_batch) {
+        run_batch();
+        return;
+    }
+
+    // Update the leaf module inputs that are the same for all leaves
+    for (auto const& x : shared_input_ptr_pairs) {
+        *x.first = *x.second;
+    }
+
+    auto input_pair = leaf_input_ptr_pairs.begin();
+    auto output_pair = leaf_output_ptr_pairs.begin();
+
+    // For each combination of layer number and leaf class:
+    for (size_t i = 0; i < nleaves; ++i) {
+        // Update the inputs to the leaf module, keeping track of whether any
+        // of them have changed since the previous leaf
+        bool inputs_changed = i == 0;
+        for (auto const end = input_pair + n_leaf_inputs; input_pair != end; ++input_pair) {
+            if (!identical_values(*input_pair->first, *input_pair->second)) {
+                *input_pair->first = *input_pair->second;
+                inputs_changed = true;
+            }
         }
 
-        // Run the leaf module
-        leaf_module->run();
+        // Run the leaf module. If the inputs are identical to those of the
+        // previous leaf, the leaf module would produce the same outputs, so
+        // there is no need to run it again. This occurs, for example, for the
+        // sunlit and shaded leaves in each layer when there is no direct light.
+        if (inputs_changed) {
+            leaf_module->run();
+        }
 
         // Update the outputs from the leaf module
-        for (auto const& x : leaf_output_ptr_pairs[i]) {
-            *x.first = *x.second;
+        for (auto const end = output_pair + n_leaf_outputs; output_pair != end; ++output_pair) {
+            *output_pair->first = *output_pair->second;
+        }
+    }
+}
+
+template <typename canopy_module_type, typename leaf_module_type>
+void multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::run_batch() const
+{
+    // Make room for one batch position per leaf; since the vectors already
+    // have enough capacity, this does not allocate any memory
+    for (std::vector<double>* v : leaf_batch_input_ptrs) {
+        v->resize(nleaves);
+    }
+
+    // Copy the inputs that change with leaf class or layer into the batch.
+    // Each leaf whose inputs are identical to those of the previous leaf
+    // shares its batch position, so the batch may contain fewer than
+    // `nleaves` positions.
+    size_t nslots = 0;
+    auto input_pair = leaf_input_ptr_pairs.begin();
+    for (size_t i = 0; i < nleaves; ++i, input_pair += n_leaf_inputs) {
+        bool inputs_changed = i == 0;
+        for (size_t j = 0; j < n_leaf_inputs && !inputs_changed; ++j) {
+            inputs_changed = !identical_values(
+                *input_pair[j].second,
+                *(input_pair + j - n_leaf_inputs)->second);
+        }
+
+        if (inputs_changed) {
+            for (size_t j = 0; j < n_leaf_inputs; ++j) {
+                (*leaf_batch_input_ptrs[j])[nslots] = *input_pair[j].second;
+            }
+            ++nslots;
+        }
+
+        leaf_slot[i] = nslots - 1;
+    }
+
+    // Set the size of the batch and copy the inputs that are the same for all
+    // leaves
+    for (std::vector<double>* v : leaf_batch_input_ptrs) {
+        v->resize(nslots);
+    }
+
+    for (std::vector<double>* v : leaf_batch_output_ptrs) {
+        v->resize(nslots);
+    }
+
+    for (auto const& x : shared_batch_input_ptr_pairs) {
+        x.first->assign(nslots, *x.second);
+    }
+
+    // Run the batched leaf module
+    leaf_module_batch->run();
+
+    // Update the outputs for each leaf from its batch position
+    auto output_pair = leaf_output_ptr_pairs.begin();
+    for (size_t i = 0; i < nleaves; ++i) {
+        for (std::vector<double> const* v : leaf_batch_output_ptrs) {
+            *(output_pair++)->first = (*v)[leaf_slot[i]];
         }
     }
 }
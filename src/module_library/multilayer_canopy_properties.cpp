@@ -2,9 +2,10 @@
 #include "multilayer_canopy_properties.h"
 #include "BioCro.h"     // for WINDprof
 #include "AuxBioCro.h"  // for LNprof
-#include "sunML.h"      // for sunML
+#include "sunML.h"      // for sunML_cache
 
 using standardBML::multilayer_canopy_properties;
+using standardBML::n_layer_canopy_properties;
 using standardBML::ten_layer_canopy_properties;
 using std::vector;
 
@@ -102,12 +103,15 @@ string_vector multilayer_canopy_properties::get_outputs(int nlayers)
 
 void multilayer_canopy_properties::run() const
 {
+    scratch_arena::frame const frame(scratch);
+
     // Calculate values of incident photosynthetically active photon flux
     // density (PPFD) and absorbed shortwave energy throughout the canopy. Note
     // that the `sunML` function expects input expects PPFD values, so we must
     // convert photosynthetically active radiation (PAR) to PPFD using the
-    // energy content of light in the PAR band
-    struct Light_profile light_profile = sunML(
+    // energy content of light in the PAR band. The light profile is only
+    // recalculated when its inputs have changed since the previous call.
+    Light_profile const& light_profile = light_cache.get_profile(
         par_incident_direct / par_energy_content,   // micromol / (m^2 beam) / s
         par_incident_diffuse / par_energy_content,  // micromol / m^2 / s
         chil,
@@ -124,12 +128,12 @@ void multilayer_canopy_properties::run() const
         nlayers);
 
     // Calculate windspeed throughout the canopy
-    vector<double> wind_speed_profile(nlayers);
-    WINDprof(windspeed, lai, wind_speed_profile);  // Modifies wind_speed_profile
+    auto wind_speed_profile = scratch.allocate<double>(nlayers);
+    WINDprof(windspeed, lai, nlayers, wind_speed_profile.data());  // Modifies wind_speed_profile
 
     // Calculate leaf nitrogen throughout the canopy
-    vector<double> leafN_profile(nlayers);
-    LNprof(LeafN, lai, kpLN, leafN_profile);  // Modifies leafN_profile
+    auto leafN_profile = scratch.allocate<double>(nlayers);
+    LNprof(LeafN, lai, kpLN, nlayers, leafN_profile.data());  // Modifies leafN_profile
 
     // Don't calculate anything based on the nitrogen profile
     if (lnfun != 0) {
@@ -196,3 +200,22 @@ void ten_layer_canopy_properties::do_operation() const
 {
     multilayer_canopy_properties::run();
 }
+
+//////////////////////////////////////
+// N LAYER CANOPY PROPERTIES MODULE //
+//////////////////////////////////////
+
+string_vector n_layer_canopy_properties::get_inputs(int nlayers)
+{
+    return multilayer_canopy_properties::get_inputs(nlayers);
+}
+
+string_vector n_layer_canopy_properties::get_outputs(int nlayers)
+{
+    return multilayer_canopy_properties::get_outputs(nlayers);
+}
+
+void n_layer_canopy_properties::do_operation() const
+{
+    multilayer_canopy_properties::run();
+}
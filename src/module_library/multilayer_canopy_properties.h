@@ -3,6 +3,8 @@
 
 #include "../framework/state_map.h"
 #include "../framework/module.h"
+#include "sunML.h"          // for sunML_cache
+#include "scratch_arena.h"  // for scratch_arena
 
 namespace standardBML
 {
@@ -138,6 +140,14 @@ class multilayer_canopy_properties : public direct_module
     std::vector<double*> const LeafN_ops;
     double* canopy_direct_transmission_fraction_op;
 
+    // Light profile from the previous call, which is reused when its inputs
+    // have not changed
+    mutable sunML_cache light_cache;
+
+    // Memory for intermediate results, which is reused between calls to
+    // avoid repeated memory allocation
+    mutable scratch_arena scratch;
+
    protected:
     void run() const;
     static string_vector get_inputs(int nlayers);
@@ -185,5 +195,38 @@ class ten_layer_canopy_properties : public multilayer_canopy_properties
     void do_operation() const;
 };
 
+//////////////////////////////////////
+// N LAYER CANOPY PROPERTIES MODULE //
+//////////////////////////////////////
+
+/**
+ * @class n_layer_canopy_properties
+ *
+ * @brief A child class of multilayer_canopy_properties where the number of
+ * layers is specified when the module is created. Instances of this class can
+ * be created using a `multilayer_module_creator`, which is retrieved using a
+ * name such as `30_layer_canopy_properties`.
+ */
+class n_layer_canopy_properties : public multilayer_canopy_properties
+{
+   public:
+    n_layer_canopy_properties(
+        int const& nlayers,
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : multilayer_canopy_properties(
+              nlayers,
+              input_quantities,
+              output_quantities)
+    {
+    }
+    static string_vector get_inputs(int nlayers);
+    static string_vector get_outputs(int nlayers);
+
+   private:
+    // Main operation
+    void do_operation() const;
+};
+
 }  // namespace standardBML
 #endif
@@ -0,0 +1,108 @@
+#ifndef MULTILAYER_MODULE_CREATOR_H
+#define MULTILAYER_MODULE_CREATOR_H
+
+#include <map>
+#include <memory>     // for std::unique_ptr
+#include <stdexcept>  // for std::out_of_range
+#include <string>
+#include "../framework/module.h"
+#include "../framework/module_creator.h"  // for module_creator
+#include "../framework/state_map.h"
+
+/**
+ * @class multilayer_module_creator
+ *
+ * @brief A `module_creator` for a multilayer module whose number of layers is
+ * specified at run time rather than compiled into the module class.
+ *
+ * The module class `T` must have a constructor with signature
+ * `T(int const& nlayers, state_map const& input_quantities,
+ * state_map* output_quantities)`, along with public static methods
+ * `get_inputs(int nlayers)` and `get_outputs(int nlayers)`.
+ *
+ * The cost of creating the module and of running it is proportional to the
+ * number of layers.
+ */
+template <typename T>
+class multilayer_module_creator : public module_creator
+{
+   public:
+    multilayer_module_creator(int nlayers, std::string const& name)
+        : nlayers{nlayers}, name{name}
+    {
+    }
+
+    string_vector get_inputs() { return T::get_inputs(nlayers); }
+    string_vector get_outputs() { return T::get_outputs(nlayers); }
+    std::string get_name() { return name; }
+
+    std::unique_ptr<module> create_module(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+    {
+        return std::unique_ptr<module>(
+            new T(nlayers, input_quantities, output_quantities));
+    }
+
+   private:
+    int const nlayers;
+    std::string const name;
+};
+
+template <typename T>
+module_creator* create_multilayer_mc(int nlayers, std::string const& name)
+{
+    return new multilayer_module_creator<T>(nlayers, name);
+}
+
+/**
+ * @brief A table of multilayer module families, where each key is a base name
+ * such as `c3_canopy` and each value creates a `multilayer_module_creator` for
+ * a particular number of layers.
+ */
+using multilayer_creator_map =
+    std::map<std::string, module_creator* (*)(int, std::string const&)>;
+
+/**
+ * @brief Creates a `multilayer_module_creator` from a module name of the form
+ * `<n>_layer_<base name>`, such as `30_layer_c3_canopy`.
+ *
+ * @param [in] entries A table of the available multilayer module families.
+ *
+ * @param [in] module_name The name of the module.
+ *
+ * @return A pointer to a new `module_creator`, or a null pointer if
+ *         `module_name` does not have the expected form or its base name is
+ *         not in `entries`. The caller takes ownership of the new object.
+ */
+inline module_creator* retrieve_multilayer_module(
+    multilayer_creator_map const& entries,
+    std::string const& module_name)
+{
+    std::string const separator = "_layer_";
+
+    size_t const n_digits = module_name.find_first_not_of("0123456789");
+
+    if (n_digits == 0 || n_digits == std::string::npos ||
+        module_name.compare(n_digits, separator.size(), separator) != 0) {
+        return nullptr;
+    }
+
+    auto const it = entries.find(module_name.substr(n_digits + separator.size()));
+
+    if (it == entries.end()) {
+        return nullptr;
+    }
+
+    int const nlayers = std::stoi(module_name.substr(0, n_digits));
+
+    if (nlayers < 1) {
+        throw std::out_of_range(
+            "Thrown by retrieve_multilayer_module: the number of layers in `" +
+            module_name + "` must be at least 1.");
+    }
+
+    return it->second(nlayers, module_name);
+}
+
+#endif
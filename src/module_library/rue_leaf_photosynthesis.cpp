@@ -12,6 +12,7 @@ using conversion_constants::celsius_to_kelvin;
 using physical_constants::dr_boundary;
 using physical_constants::dr_stomata;
 using standardBML::rue_leaf_photosynthesis;
+using standardBML::rue_leaf_photosynthesis_batch;
 
 // Determine assimilation, stomatal conductance, and Ci following `c3photoC()`.
 // Here, rather than using the FvCB model for C3 photosynthesis, gross
@@ -183,3 +184,70 @@ void rue_leaf_photosynthesis::do_operation() const
     update(leaf_temperature_op, leaf_temperature);
     update(gbw_op, et.gbw_molecular);
 }
+
+void rue_leaf_photosynthesis_batch::do_operation() const
+{
+    // Make an initial guess for boundary layer conductance
+    double const gbw_guess{1.2};  // mol / m^2 / s
+
+    // The RUE model does not require any iteration, so the calculations for
+    // each leaf are simply performed in a single loop
+    for (size_t i = 0; i < incident_ppfd.size(); ++i) {
+        // Get an initial estimate of stomatal conductance, assuming the leaf
+        // is at air temperature
+        const double initial_stomatal_conductance =
+            rue_photo(
+                incident_ppfd[i] * 1e-6,  // mol / m^2 / s
+                alpha_rue[i],             // dimensionless
+                temp[i],                  // degrees C
+                rh[i],                    // dimensionless from Pa / Pa
+                Rd[i] * 1e-6,             // mol / m^2 / s
+                b0[i],                    // mol / m^2 / s
+                b1[i],                    // dimensionless
+                Catm[i] * 1e-6,           // dimensionless from mol / mol
+                gbw_guess                 // mol / m^2 / s
+                )
+                .Gs;  // mol / m^2 / s
+
+        // Calculate a new value for leaf temperature
+        const energy_balance_outputs et = leaf_energy_balance(
+            absorbed_longwave[i],
+            absorbed_shortwave[i],
+            atmospheric_pressure[i],
+            temp[i],
+            gbw_canopy[i],
+            leafwidth[i],
+            rh[i],
+            initial_stomatal_conductance,
+            windspeed[i]);
+
+        const double leaf_temperature = temp[i] + et.Deltat;  // degrees C
+
+        // Calculate final values for assimilation, stomatal conductance, and
+        // Ci using the new leaf temperature
+        const photosynthesis_outputs photo =
+            rue_photo(
+                incident_ppfd[i] * 1e-6,  // mol / m^2 / s
+                alpha_rue[i],             // dimensionless
+                leaf_temperature,         // degrees C
+                rh[i],                    // dimensionless from Pa / Pa
+                Rd[i] * 1e-6,             // mol / m^2 / s
+                b0[i],                    // mol / m^2 / s
+                b1[i],                    // dimensionless
+                Catm[i] * 1e-6,           // dimensionless from mol / mol
+                et.gbw_molecular          // mol / m^2 / s
+            );
+
+        // Update the outputs
+        (*Assim_op)[i] = photo.Assim;
+        (*GrossAssim_op)[i] = photo.GrossAssim;
+        (*Rp_op)[i] = photo.Rp;
+        (*Ci_op)[i] = photo.Ci;
+        (*Gs_op)[i] = photo.Gs;
+        (*TransR_op)[i] = et.TransR;
+        (*EPenman_op)[i] = et.EPenman;
+        (*EPriestly_op)[i] = et.EPriestly;
+        (*leaf_temperature_op)[i] = leaf_temperature;
+        (*gbw_op)[i] = et.gbw_molecular;
+    }
+}
@@ -1,11 +1,98 @@
 #ifndef RUE_LEAF_PHOTOSYNTHESIS_H
 #define RUE_LEAF_PHOTOSYNTHESIS_H
 
+#include <vector>
 #include "../framework/module.h"
 #include "../framework/state_map.h"
+#include "leaf_batch.h"  // for leaf_batch
 
 namespace standardBML
 {
+class rue_leaf_photosynthesis;
+
+/**
+ * @class rue_leaf_photosynthesis_batch
+ *
+ * @brief The batched version of `rue_leaf_photosynthesis`; see `leaf_batch` for
+ * more details.
+ */
+class rue_leaf_photosynthesis_batch : public leaf_batch
+{
+   public:
+    using module_type = rue_leaf_photosynthesis;
+
+    rue_leaf_photosynthesis_batch(
+        state_vector_map const& input_quantities,
+        state_vector_map* output_quantities)
+        : leaf_batch{},
+
+          // Get references to input quantity vectors
+          absorbed_longwave{get_batch_input(input_quantities, "absorbed_longwave")},
+          absorbed_shortwave{get_batch_input(input_quantities, "absorbed_shortwave")},
+          alpha_rue{get_batch_input(input_quantities, "alpha_rue")},
+          atmospheric_pressure{get_batch_input(input_quantities, "atmospheric_pressure")},
+          b0{get_batch_input(input_quantities, "b0")},
+          b1{get_batch_input(input_quantities, "b1")},
+          Catm{get_batch_input(input_quantities, "Catm")},
+          gbw_canopy{get_batch_input(input_quantities, "gbw_canopy")},
+          height{get_batch_input(input_quantities, "height")},
+          incident_ppfd{get_batch_input(input_quantities, "incident_ppfd")},
+          leafwidth{get_batch_input(input_quantities, "leafwidth")},
+          Rd{get_batch_input(input_quantities, "Rd")},
+          rh{get_batch_input(input_quantities, "rh")},
+          temp{get_batch_input(input_quantities, "temp")},
+          windspeed{get_batch_input(input_quantities, "windspeed")},
+          windspeed_height{get_batch_input(input_quantities, "windspeed_height")},
+
+          // Get pointers to output quantity vectors
+          Assim_op{get_batch_op(output_quantities, "Assim")},
+          GrossAssim_op{get_batch_op(output_quantities, "GrossAssim")},
+          Rp_op{get_batch_op(output_quantities, "Rp")},
+          Ci_op{get_batch_op(output_quantities, "Ci")},
+          Gs_op{get_batch_op(output_quantities, "Gs")},
+          TransR_op{get_batch_op(output_quantities, "TransR")},
+          EPenman_op{get_batch_op(output_quantities, "EPenman")},
+          EPriestly_op{get_batch_op(output_quantities, "EPriestly")},
+          leaf_temperature_op{get_batch_op(output_quantities, "leaf_temperature")},
+          gbw_op{get_batch_op(output_quantities, "gbw")}
+    {
+    }
+
+   private:
+    // References to input quantity vectors
+    std::vector<double> const& absorbed_longwave;
+    std::vector<double> const& absorbed_shortwave;
+    std::vector<double> const& alpha_rue;
+    std::vector<double> const& atmospheric_pressure;
+    std::vector<double> const& b0;
+    std::vector<double> const& b1;
+    std::vector<double> const& Catm;
+    std::vector<double> const& gbw_canopy;
+    std::vector<double> const& height;
+    std::vector<double> const& incident_ppfd;
+    std::vector<double> const& leafwidth;
+    std::vector<double> const& Rd;
+    std::vector<double> const& rh;
+    std::vector<double> const& temp;
+    std::vector<double> const& windspeed;
+    std::vector<double> const& windspeed_height;
+
+    // Pointers to output quantity vectors
+    std::vector<double>* Assim_op;
+    std::vector<double>* GrossAssim_op;
+    std::vector<double>* Rp_op;
+    std::vector<double>* Ci_op;
+    std::vector<double>* Gs_op;
+    std::vector<double>* TransR_op;
+    std::vector<double>* EPenman_op;
+    std::vector<double>* EPriestly_op;
+    std::vector<double>* leaf_temperature_op;
+    std::vector<double>* gbw_op;
+
+    // Main operation
+    void do_operation() const;
+};
+
 /**
  *  @class rue_leaf_photosynthesis
  *
@@ -168,6 +255,9 @@ class rue_leaf_photosynthesis : public direct_module
     static string_vector get_outputs();
     static std::string get_name() { return "rue_leaf_photosynthesis"; }
 
+    // Batched version of this module
+    using batch_type = rue_leaf_photosynthesis_batch;
+
    private:
     // References to input parameters
     double const& absorbed_longwave;
@@ -0,0 +1,54 @@
+#include <atomic>  // for std::atomic
+#include "scratch_arena.h"
+
+namespace
+{
+std::atomic<unsigned long> scratch_arena_heap_allocations{0};
+}  // namespace
+
+void* scratch_arena::allocate_units(size_t units)
+{
+    void* result;
+
+    if (units == 0) {
+        return block.get();
+    }
+
+    if (used + units <= capacity) {
+        result = block.get() + used;
+    } else {
+        overflow.emplace_back(new unit[units]);
+        ++scratch_arena_heap_allocations;
+        result = overflow.back().get();
+    }
+
+    used += units;
+    peak = std::max(peak, used);
+
+    return result;
+}
+
+void scratch_arena::release_to(size_t mark)
+{
+    used = mark;
+
+    // When nothing is in use, replace the main block and any overflow blocks
+    // with one block that can hold all of the memory that has been needed at
+    // once, so later runs do not need to allocate
+    if (used == 0 && !overflow.empty()) {
+        overflow.clear();
+        block.reset(new unit[peak]);
+        ++scratch_arena_heap_allocations;
+        capacity = peak;
+    }
+}
+
+scratch_arena_statistics get_scratch_arena_statistics()
+{
+    return scratch_arena_statistics{scratch_arena_heap_allocations};
+}
+
+void reset_scratch_arena_statistics()
+{
+    scratch_arena_heap_allocations = 0;
+}
@@ -0,0 +1,130 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <algorithm>    // for std::fill, std::min, std::max
+#include <cstddef>      // for size_t, std::max_align_t
+#include <memory>       // for std::unique_ptr
+#include <type_traits>  // for std::is_trivially_destructible
+#include <vector>       // for std::vector
+
+/**
+ * @class scratch_span
+ *
+ * @brief A view of a contiguous sequence of objects that were allocated from a
+ * `scratch_arena`. A span does not own its elements; it remains valid until
+ * the `scratch_arena::frame` that was active when it was allocated goes out of
+ * scope.
+ */
+template <typename T>
+class scratch_span
+{
+   public:
+    scratch_span() : first{nullptr}, n{0} {}
+    scratch_span(T* first, size_t n) : first{first}, n{n} {}
+
+    T& operator[](size_t i) const { return first[i]; }
+    T* data() const { return first; }
+    T* begin() const { return first; }
+    T* end() const { return first + n; }
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+
+    // Reduces the number of elements in the view without releasing any memory
+    void truncate(size_t new_size) { n = std::min(n, new_size); }
+
+   private:
+    T* first;
+    size_t n;
+};
+
+/**
+ * @class scratch_arena
+ *
+ * @brief A bump allocator for temporary arrays that are needed while a module
+ * runs but not between runs.
+ *
+ * Allocating from an arena only advances an offset into a block of memory it
+ * already owns. Memory is returned to the arena in bulk when a
+ * `scratch_arena::frame` goes out of scope, so a module typically creates a
+ * frame at the start of `do_operation()` and allocates everything it needs
+ * from the arena after that. Functions called by the module can create their
+ * own nested frames to release their temporary arrays before returning.
+ *
+ * If an allocation does not fit in the current block, a separate block is
+ * allocated from the heap to hold it. When the outermost frame is released,
+ * these blocks are replaced by a single block large enough for all of the
+ * memory that was in use at the same time. After the first few runs, a module
+ * that needs the same amount of memory on every run therefore never allocates
+ * heap memory. The number of heap allocations made by all arenas is reported
+ * by `get_scratch_arena_statistics()`.
+ *
+ * Only types that do not need a destructor can be allocated from an arena.
+ *
+ * An arena should be owned by a single module instance; it is not safe to
+ * share one between threads.
+ */
+class scratch_arena
+{
+   public:
+    scratch_arena() = default;
+    scratch_arena(scratch_arena const&) = delete;
+    scratch_arena& operator=(scratch_arena const&) = delete;
+
+    /**
+     * @brief Allocates `n` objects of type `T`, each initialized to `value`.
+     */
+    template <typename T>
+    scratch_span<T> allocate(size_t n, T const& value = T())
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "scratch_arena can only allocate trivially destructible types");
+
+        size_t const units = (n * sizeof(T) + sizeof(unit) - 1) / sizeof(unit);
+        T* const first = static_cast<T*>(allocate_units(units));
+        std::fill(first, first + n, value);
+        return scratch_span<T>(first, n);
+    }
+
+    /**
+     * @brief Marks the current position of an arena and returns all memory
+     * allocated after that point to the arena when it goes out of scope.
+     */
+    class frame
+    {
+       public:
+        explicit frame(scratch_arena& arena) : arena(arena), mark{arena.used} {}
+        ~frame() { arena.release_to(mark); }
+        frame(frame const&) = delete;
+        frame& operator=(frame const&) = delete;
+
+       private:
+        scratch_arena& arena;
+        size_t const mark;
+    };
+
+   private:
+    using unit = std::max_align_t;
+
+    std::unique_ptr<unit[]> block;                  // main block of memory
+    std::vector<std::unique_ptr<unit[]>> overflow;  // allocations that did not fit
+    size_t capacity = 0;                            // units in `block`
+    size_t used = 0;                                // units currently in use
+    size_t peak = 0;                                // maximum of `used`
+
+    void* allocate_units(size_t units);
+    void release_to(size_t mark);
+};
+
+/**
+ * @brief The number of times any `scratch_arena` has allocated memory from the
+ * heap.
+ */
+struct scratch_arena_statistics {
+    unsigned long heap_allocations;
+};
+
+scratch_arena_statistics get_scratch_arena_statistics();
+
+void reset_scratch_arena_statistics();
+
+#endif
@@ -1,3 +1,7 @@
+#include <atomic>     // for std::atomic
+#include <cmath>      // for exp, pow, sqrt, acos, tan
+#include <cstring>    // for std::memcmp, std::memcpy
+#include <stdexcept>  // for std::out_of_range
 #include "sunML.h"
 
 /**
@@ -401,11 +405,14 @@ double shaded_radiation(
  *
  *  @param [in] nlayers Integer number of layers in the canopy
  *
- *  @return An n-layered light profile representing quantities within
- *          the canopy, including several photon flux densities and
- *          the relative fractions of shaded and sunlit leaves
+ *  @param [out] light_profile An n-layered light profile representing
+ *               quantities within the canopy, including several photon flux
+ *               densities and the relative fractions of shaded and sunlit
+ *               leaves. Its vectors are resized to `nlayers` elements, so no
+ *               memory is allocated when the same profile object is reused
+ *               with the same (or a smaller) number of layers.
  */
-Light_profile sunML(
+void sunML(
     double ambient_ppfd_beam,       // micromol / (m^2 beam) / s
     double ambient_ppfd_diffuse,    // micromol / m^2 / s
     double chil,                    // dimensionless from m^2 / m^2
@@ -419,11 +426,12 @@ Light_profile sunML(
     double leaf_transmittance_par,  // dimensionless
     double par_energy_content,      // J / micromol
     double par_energy_fraction,     // dimensionless
-    int nlayers                     // dimensionless
+    int nlayers,                    // dimensionless
+    Light_profile& light_profile    // calculated values
 )
 {
-    if (nlayers < 1 || nlayers > MAXLAY) {
-        throw std::out_of_range("nlayers must be at least 1 but no more than MAXLAY.");
+    if (nlayers < 1) {
+        throw std::out_of_range("nlayers must be at least 1.");
     }
 
     if (cosine_zenith_angle > 1 || cosine_zenith_angle < -1) {
@@ -497,7 +505,7 @@ Light_profile sunML(
         ambient_ppfd_beam_leaf, par_energy_content, par_energy_fraction);  // J / (m^2 leaf) / s
 
     // Start to fill in the light profile values
-    Light_profile light_profile;
+    light_profile.resize(nlayers);
     light_profile.canopy_direct_transmission_fraction = canopy_direct_transmission_fraction;
 
     // Fill in the layer-dependent light profile values
@@ -578,5 +586,98 @@ Light_profile sunML(
                 leaf_reflectance_nir,
                 leaf_transmittance_nir);  // J / (m^2 leaf) / s
     }
-    return light_profile;
+}
+
+namespace
+{
+std::atomic<unsigned long> sunML_cache_hits{0};
+std::atomic<unsigned long> sunML_cache_misses{0};
+}  // namespace
+
+/**
+ *  @brief Returns the light profile calculated by `sunML()` for the specified
+ *  inputs, reusing the previously calculated profile if none of the inputs
+ *  have changed since the last call.
+ *
+ *  The inputs are compared using their binary representations, so a cache hit
+ *  always returns exactly the same profile that `sunML()` would return.
+ *
+ *  @return A reference to the stored light profile, which remains valid until
+ *          the next call to `get_profile()`.
+ */
+Light_profile const& sunML_cache::get_profile(
+    double ambient_ppfd_beam,       // micromol / (m^2 beam) / s
+    double ambient_ppfd_diffuse,    // micromol / m^2 / s
+    double chil,                    // dimensionless from m^2 / m^2
+    double cosine_zenith_angle,     // dimensionless
+    double heightf,                 // m^-1 from m^2 leaf / m^2 ground / m height
+    double k_diffuse,               // dimensionless
+    double lai,                     // dimensionless from m^2 / m^2
+    double leaf_reflectance_nir,    // dimensionless
+    double leaf_reflectance_par,    // dimensionless
+    double leaf_transmittance_nir,  // dimensionless
+    double leaf_transmittance_par,  // dimensionless
+    double par_energy_content,      // J / micromol
+    double par_energy_fraction,     // dimensionless
+    int nlayers                     // dimensionless
+)
+{
+    double const new_inputs[n_inputs] = {
+        ambient_ppfd_beam,
+        ambient_ppfd_diffuse,
+        chil,
+        cosine_zenith_angle,
+        heightf,
+        k_diffuse,
+        lai,
+        leaf_reflectance_nir,
+        leaf_reflectance_par,
+        leaf_transmittance_nir,
+        leaf_transmittance_par,
+        par_energy_content,
+        par_energy_fraction,
+        static_cast<double>(nlayers)};
+
+    if (valid && std::memcmp(inputs, new_inputs, sizeof(inputs)) == 0) {
+        ++sunML_cache_hits;
+        return profile;
+    }
+
+    ++sunML_cache_misses;
+
+    // Invalidate the cache in case `sunML()` throws an exception
+    valid = false;
+
+    sunML(
+        ambient_ppfd_beam,
+        ambient_ppfd_diffuse,
+        chil,
+        cosine_zenith_angle,
+        heightf,
+        k_diffuse,
+        lai,
+        leaf_reflectance_nir,
+        leaf_reflectance_par,
+        leaf_transmittance_nir,
+        leaf_transmittance_par,
+        par_energy_content,
+        par_energy_fraction,
+        nlayers,
+        profile);
+
+    std::memcpy(inputs, new_inputs, sizeof(inputs));
+    valid = true;
+
+    return profile;
+}
+
+sunML_cache_statistics get_sunML_cache_statistics()
+{
+    return sunML_cache_statistics{sunML_cache_hits, sunML_cache_misses};
+}
+
+void reset_sunML_cache_statistics()
+{
+    sunML_cache_hits = 0;
+    sunML_cache_misses = 0;
 }
@@ -1,21 +1,44 @@
 #ifndef SUNML_H
 #define SUNML_H
 
-#include "AuxBioCro.h"  // for MAXLAY
+#include <cstddef>  // for size_t
+#include <vector>   // for std::vector
 
+/**
+ * @brief Quantities calculated by `sunML()` for each layer of a multilayer
+ * canopy. Each vector has one element per layer, so the number of layers is
+ * only limited by available memory.
+ */
 struct Light_profile {
-    double canopy_direct_transmission_fraction;  // dimensionless
-    double height[MAXLAY];                       // m
-    double shaded_absorbed_ppfd[MAXLAY];         // micromol / (m^2 leaf) / s
-    double shaded_absorbed_shortwave[MAXLAY];    // J / (m^2 leaf) / s
-    double shaded_fraction[MAXLAY];              // dimensionless
-    double shaded_incident_nir[MAXLAY];          // J / (m^2 leaf) / s
-    double shaded_incident_ppfd[MAXLAY];         // micromol / (m^2 leaf) / s
-    double sunlit_absorbed_ppfd[MAXLAY];         // micromol / (m^2 leaf) / s
-    double sunlit_absorbed_shortwave[MAXLAY];    // J / (m^2 leaf) / s
-    double sunlit_fraction[MAXLAY];              // dimensionless
-    double sunlit_incident_nir[MAXLAY];          // J / (m^2 leaf) / s
-    double sunlit_incident_ppfd[MAXLAY];         // micromol / (m^2 leaf) / s
+    double canopy_direct_transmission_fraction;     // dimensionless
+    std::vector<double> height;                     // m
+    std::vector<double> shaded_absorbed_ppfd;       // micromol / (m^2 leaf) / s
+    std::vector<double> shaded_absorbed_shortwave;  // J / (m^2 leaf) / s
+    std::vector<double> shaded_fraction;            // dimensionless
+    std::vector<double> shaded_incident_nir;        // J / (m^2 leaf) / s
+    std::vector<double> shaded_incident_ppfd;       // micromol / (m^2 leaf) / s
+    std::vector<double> sunlit_absorbed_ppfd;       // micromol / (m^2 leaf) / s
+    std::vector<double> sunlit_absorbed_shortwave;  // J / (m^2 leaf) / s
+    std::vector<double> sunlit_fraction;            // dimensionless
+    std::vector<double> sunlit_incident_nir;        // J / (m^2 leaf) / s
+    std::vector<double> sunlit_incident_ppfd;       // micromol / (m^2 leaf) / s
+
+    // Sets the number of layers; memory is only allocated when the new number
+    // of layers is larger than any previous one
+    void resize(size_t nlayers)
+    {
+        height.resize(nlayers);
+        shaded_absorbed_ppfd.resize(nlayers);
+        shaded_absorbed_shortwave.resize(nlayers);
+        shaded_fraction.resize(nlayers);
+        shaded_incident_nir.resize(nlayers);
+        shaded_incident_ppfd.resize(nlayers);
+        sunlit_absorbed_ppfd.resize(nlayers);
+        sunlit_absorbed_shortwave.resize(nlayers);
+        sunlit_fraction.resize(nlayers);
+        sunlit_incident_nir.resize(nlayers);
+        sunlit_incident_ppfd.resize(nlayers);
+    }
 };
 
 double thin_layer_absorption(
@@ -71,7 +94,7 @@ double shaded_radiation(
     double ell         // dimensionless from m^2 leaf / m^2 ground
 );
 
-Light_profile sunML(
+void sunML(
     double ambient_ppfd_beam,       // micromol / (m^2 beam) / s
     double ambient_ppfd_diffuse,    // micromol / m^2 / s
     double chil,                    // dimensionless from m^2 / m^2
@@ -85,7 +108,67 @@ Light_profile sunML(
     double leaf_transmittance_par,  // dimensionless
     double par_energy_content,      // J / micromol
     double par_energy_fraction,     // dimensionless
-    int nlayers                     // dimensionless
+    int nlayers,                    // dimensionless
+    Light_profile& light_profile    // calculated values
 );
 
+/**
+ * @brief Stores the most recent output of `sunML()` along with the inputs used
+ * to calculate it, so the light profile only needs to be recalculated when one
+ * of the inputs changes.
+ *
+ * During a simulation, a canopy module is often evaluated several times in a
+ * row with exactly the same inputs; for example, when the state at the start
+ * of an ODE solver step is used to record the output and also to begin the
+ * next step, or when the same system is evaluated repeatedly at one time
+ * point. In these cases the stored profile is returned without calling
+ * `sunML()`.
+ *
+ * Inputs are only considered to be unchanged when they are bit-for-bit
+ * identical to the stored ones, so the light profile is exactly the same as
+ * the one `sunML()` would calculate.
+ *
+ * A cache should be owned by a single module instance; it is not safe to share
+ * one between threads.
+ */
+class sunML_cache
+{
+   public:
+    Light_profile const& get_profile(
+        double ambient_ppfd_beam,       // micromol / (m^2 beam) / s
+        double ambient_ppfd_diffuse,    // micromol / m^2 / s
+        double chil,                    // dimensionless from m^2 / m^2
+        double cosine_zenith_angle,     // dimensionless
+        double heightf,                 // m^-1 from m^2 leaf / m^2 ground / m height
+        double k_diffuse,               // dimensionless
+        double lai,                     // dimensionless from m^2 / m^2
+        double leaf_reflectance_nir,    // dimensionless
+        double leaf_reflectance_par,    // dimensionless
+        double leaf_transmittance_nir,  // dimensionless
+        double leaf_transmittance_par,  // dimensionless
+        double par_energy_content,      // J / micromol
+        double par_energy_fraction,     // dimensionless
+        int nlayers                     // dimensionless
+    );
+
+   private:
+    static int const n_inputs = 14;
+    bool valid = false;
+    double inputs[n_inputs];
+    Light_profile profile;
+};
+
+/**
+ * @brief Counts of the number of times any `sunML_cache` was able to reuse a
+ * stored light profile (`hits`) or had to call `sunML()` (`misses`).
+ */
+struct sunML_cache_statistics {
+    unsigned long hits;
+    unsigned long misses;
+};
+
+sunML_cache_statistics get_sunML_cache_statistics();
+
+void reset_sunML_cache_statistics();
+
 #endif
@@ -52,16 +52,16 @@ namespace standardBML
  *  In general, this model will be solved for a set of N time points `t_0`,
  *  `t_1`, ..., `t_{N-1}`. We can think of them as being labeled by an integer
  *  "index" i = 0, 1, ..., N-1. So, at each time point, this module stores the
- *  net rate of carbon assimilation due to photosynthesis in its
- *  `assim_rate_XXX_vec` members. When senescence begins for an organ, the
- *  senescence rate is determined from the 0th element of its associated
- *  `assim_rate_XXX_vec` vector. For the next timestep, element 1 is used. So on
- *  and so forth. This module uses the "senescence index" quantities to keep
- *  track of the index to use for senescence calculations.
+ *  net rate of carbon assimilation due to photosynthesis for each organ in its
+ *  `growth_history` member. When senescence begins for an organ, the
+ *  senescence rate is determined from the organ's rate in the 0th element of
+ *  `growth_history`. For the next timestep, element 1 is used. So on and so
+ *  forth. This module uses the "senescence index" quantities to keep track of
+ *  the index to use for senescence calculations.
  *
  *  Special care must be taken for the rhizome, since it may begin the
  *  simulation as a carbon source rather than a carbon sink. In this case, the
- *  0th element of the `assim_rate_rhizome_vec` vector would not correspond to
+ *  rhizome rate in the 0th element of `growth_history` would not correspond to
  *  the rhizome's first timestep of growth. To account for this, the
  *  `rhizome_senescence_index` must be incremented while it is a carbon source.
  *  Then, when senescence kicks in later, the rhizome senescence index will
@@ -138,15 +138,24 @@ class thermal_time_senescence : public differential_module
     static std::string get_name() { return "thermal_time_senescence"; }
 
    private:
-    // Vectors for storing information about growth history
+    // The net assimilation rates of each organ during one timestep
+    struct growth_record {
+        double leaf;     // Mg / ha / hour
+        double stem;     // Mg / ha / hour
+        double root;     // Mg / ha / hour
+        double rhizome;  // Mg / ha / hour
+    };
+
+    // Growth history, with one element added each time the derivatives are
+    // calculated, which is once per timestep with the required Euler solver.
+    // The rates for all organs are stored together so the history grows as a
+    // single buffer, which is reallocated a number of times that only grows
+    // logarithmically with the length of the simulation.
     //  Note: this feature is peculiar to this module
     //   and should be avoided in general since it
     //   precludes the use of any integration method
     //   except fixed-step Euler
-    std::vector<double> mutable assim_rate_leaf_vec;
-    std::vector<double> mutable assim_rate_stem_vec;
-    std::vector<double> mutable assim_rate_root_vec;
-    std::vector<double> mutable assim_rate_rhizome_vec;
+    std::vector<growth_record> mutable growth_history;
 
     // Pointers to input quantities
     double const& TTc;
@@ -232,11 +241,12 @@ string_vector thermal_time_senescence::get_outputs()
 
 void thermal_time_senescence::do_operation() const
 {
-    // Add the new tissue growth to the history vectors
-    assim_rate_leaf_vec.push_back(net_assimilation_rate_leaf);
-    assim_rate_stem_vec.push_back(net_assimilation_rate_stem);
-    assim_rate_root_vec.push_back(net_assimilation_rate_root);
-    assim_rate_rhizome_vec.push_back(net_assimilation_rate_rhizome);
+    // Add the new tissue growth to the history
+    growth_history.push_back(growth_record{
+        net_assimilation_rate_leaf,
+        net_assimilation_rate_stem,
+        net_assimilation_rate_root,
+        net_assimilation_rate_rhizome});
 
     // Initialize variables
     double dLeaf{0.0};
@@ -255,7 +265,7 @@ void thermal_time_senescence::do_operation() const
 
     if (TTc >= seneLeaf) {
         // Look back in time to find out how much the tissue grew in the past
-        double change = assim_rate_leaf_vec.at(leaf_senescence_index);
+        double change = growth_history.at(leaf_senescence_index).leaf;
 
         // Subtract the rate of new growth that occurred in the past from the
         // derivative
@@ -274,7 +284,7 @@ void thermal_time_senescence::do_operation() const
 
     if (TTc >= seneStem) {
         // Look back in time to find out how much the tissue grew in the past
-        double change = assim_rate_stem_vec.at(stem_senescence_index);
+        double change = growth_history.at(stem_senescence_index).stem;
 
         // Subtract the rate of new growth that occurred in the past from the
         // derivative
@@ -289,7 +299,7 @@ void thermal_time_senescence::do_operation() const
 
     if (TTc >= seneRoot) {
         // Look back in time to find out how much the tissue grew in the past
-        double change = assim_rate_root_vec.at(root_senescence_index);
+        double change = growth_history.at(root_senescence_index).root;
 
         // Subtract the rate of new growth that occurred in the past from the
         // derivative
@@ -309,7 +319,7 @@ void thermal_time_senescence::do_operation() const
 
     if (TTc >= seneRhizome) {
         // Look back in time to find out how much the tissue grew in the past
-        double change = assim_rate_rhizome_vec.at(rhizome_senescence_index);
+        double change = growth_history.at(rhizome_senescence_index).rhizome;
 
         // Subtract the rate of new growth that occurred in the past from the
         // derivative
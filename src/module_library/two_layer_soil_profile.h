@@ -102,6 +102,10 @@ class two_layer_soil_profile : public differential_module
     double* cws2_op;
     double* soil_water_content_op;
 
+    // The soil profile calculated by `soilML`, which is kept between calls so
+    // its per-layer quantities are only allocated once
+    mutable soilML_str soilMLS;
+
     // Main operation
     void do_operation() const;
 };
@@ -160,14 +164,14 @@ void two_layer_soil_profile::do_operation() const
     double cws[] = {cws1, cws2};
     double soil_depths[] = {soil_depth1, soil_depth2, soil_depth3};
 
-    struct soilML_str soilMLS = soilML(
+    soilML(
         precip, canopy_transpiration_rate, cws, soil_depth3, soil_depths,
         soil_field_capacity, soil_wilting_point, soil_saturation_capacity,
         soil_air_entry, soil_saturated_conductivity, soil_b_coefficient,
         soil_sand_content, phi1, phi2, wsFun, 2 /* Always uses 2 layers */,
         Root, lai, 0.68, temp, solar, windspeed, rh, hydrDist, rfl, rsec, rsdf,
         soil_clod_size, soil_reflectance, soil_transmission,
-        specific_heat_of_air, par_energy_content);
+        specific_heat_of_air, par_energy_content, soilMLS);
 
     double layer_one_depth = soil_depth2 - soil_depth1;
     double layer_two_depth = soil_depth3 - soil_depth2;
@@ -0,0 +1,256 @@
+#include <algorithm>  // for std::sort
+#include <atomic>     // for std::atomic
+#include <chrono>     // for std::chrono::steady_clock
+#include <cmath>      // for std::isnan
+#include <cstdio>     // for std::snprintf
+#include <mutex>      // for std::mutex, std::lock_guard
+#include <set>
+#include <vector>
+#include "module_trace.h"
+
+using std::string;
+
+namespace
+{
+struct trace_event {
+    char const* name;
+    char const* category;
+    long long nanoseconds;  // since the trace was started
+    double time;            // simulation time, or NaN
+    char phase;
+};
+
+/**
+ *  @brief A fixed-size buffer holding the most recent events recorded by one
+ *  thread.
+ *
+ *  @details Only the owning thread writes to a buffer, so recording an event
+ *  requires no synchronization other than publishing the new number of
+ *  events. When the buffer is full, each new event overwrites the oldest one.
+ *  The buffer is only read after all threads have stopped recording.
+ */
+struct trace_ring_buffer {
+    trace_ring_buffer(size_t capacity, unsigned long thread_id)
+        : events{new trace_event[capacity]},
+          capacity{capacity},
+          thread_id{thread_id}
+    {
+    }
+
+    void push(trace_event const& e)
+    {
+        size_t const n = count.load(std::memory_order_relaxed);
+        events[n % capacity] = e;
+        count.store(n + 1, std::memory_order_release);
+    }
+
+    std::unique_ptr<trace_event[]> const events;
+    size_t const capacity;
+    unsigned long const thread_id;
+    std::atomic<size_t> count{0};  // total number of events recorded
+    trace_ring_buffer* next = nullptr;
+};
+
+std::atomic<bool> enabled{false};
+
+// Incremented whenever a trace is started, so each thread can tell whether
+// its buffer belongs to the current trace
+std::atomic<unsigned long> generation{0};
+
+// All buffers for the current trace, as a singly-linked list that threads add
+// to with a compare-and-swap when they record their first event
+std::atomic<trace_ring_buffer*> buffers{nullptr};
+
+std::atomic<unsigned long> next_thread_id{1};
+size_t capacity = 0;
+std::chrono::steady_clock::time_point start_time;
+
+// Interned names are only added while modules are being set up, never while
+// events are being recorded. They are never removed, since there is only one
+// for each distinct module name.
+std::mutex names_mutex;
+std::set<string> names;
+
+struct thread_buffer {
+    trace_ring_buffer* buffer;
+    unsigned long generation;
+};
+
+thread_local thread_buffer local_buffer{nullptr, 0};
+
+trace_ring_buffer* get_thread_buffer()
+{
+    unsigned long const current = generation.load(std::memory_order_acquire);
+
+    if (local_buffer.buffer == nullptr || local_buffer.generation != current) {
+        trace_ring_buffer* b = new trace_ring_buffer(capacity, next_thread_id++);
+        b->next = buffers.load(std::memory_order_relaxed);
+        while (!buffers.compare_exchange_weak(b->next, b, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        }
+        local_buffer = thread_buffer{b, current};
+    }
+
+    return local_buffer.buffer;
+}
+
+void delete_buffers()
+{
+    trace_ring_buffer* b = buffers.exchange(nullptr);
+    while (b != nullptr) {
+        trace_ring_buffer* const next = b->next;
+        delete b;
+        b = next;
+    }
+}
+
+string escape_json(char const* s)
+{
+    string result;
+    for (; *s != '\0'; ++s) {
+        if (*s == '"' || *s == '\\') {
+            result += '\\';
+        }
+        result += *s;
+    }
+    return result;
+}
+
+}  // namespace
+
+void start_module_trace(size_t events_per_thread)
+{
+    enabled = false;
+    delete_buffers();
+
+    capacity = events_per_thread > 0 ? events_per_thread : 1;
+    next_thread_id = 1;
+    start_time = std::chrono::steady_clock::now();
+    ++generation;
+    enabled = true;
+}
+
+bool module_trace_enabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+char const* intern_trace_name(string const& name)
+{
+    std::lock_guard<std::mutex> lock(names_mutex);
+    return names.insert(name).first->c_str();
+}
+
+void record_trace_event(
+    char const* name,
+    char const* category,
+    char phase,
+    double time)
+{
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    long long const nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time)
+            .count();
+
+    get_thread_buffer()->push(trace_event{name, category, nanoseconds, time, phase});
+}
+
+/**
+ *  @brief Replaces the module creators for a dynamical system with
+ *  `traced_module_creator` objects that wrap them, which are stored in
+ *  `traced_mcs`.
+ */
+void trace_modules(
+    mc_vector& direct_mcs,
+    mc_vector& differential_mcs,
+    std::vector<std::unique_ptr<traced_module_creator>>& traced_mcs)
+{
+    for (module_creator*& mc : direct_mcs) {
+        traced_mcs.emplace_back(new traced_module_creator(mc, false, false));
+        mc = traced_mcs.back().get();
+    }
+
+    for (size_t i = 0; i < differential_mcs.size(); ++i) {
+        traced_mcs.emplace_back(new traced_module_creator(
+            differential_mcs[i], i == 0, i + 1 == differential_mcs.size()));
+        differential_mcs[i] = traced_mcs.back().get();
+    }
+}
+
+/**
+ *  @details Each thread's events are written in the order they were
+ *  recorded. If the oldest events of a thread were overwritten, any end
+ *  events whose matching begin events were lost are also omitted, so every
+ *  span in the file has a beginning.
+ */
+module_trace_summary stop_module_trace(std::ostream& out)
+{
+    enabled = false;
+
+    std::vector<trace_ring_buffer const*> thread_buffers;
+    for (trace_ring_buffer const* b = buffers.load(std::memory_order_acquire);
+         b != nullptr; b = b->next) {
+        thread_buffers.push_back(b);
+    }
+
+    std::sort(thread_buffers.begin(), thread_buffers.end(),
+              [](trace_ring_buffer const* a, trace_ring_buffer const* b) {
+                  return a->thread_id < b->thread_id;
+              });
+
+    module_trace_summary summary;
+    summary.threads = thread_buffers.size();
+
+    out << "{\"traceEvents\":[";
+
+    char line[128];
+    bool first = true;
+
+    for (trace_ring_buffer const* b : thread_buffers) {
+        std::snprintf(line, sizeof(line),
+                      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,"
+                      "\"args\":{\"name\":\"BioCro thread %lu\"}}",
+                      b->thread_id, b->thread_id);
+        out << (first ? "\n" : ",\n") << line;
+        first = false;
+
+        size_t const count = b->count.load(std::memory_order_acquire);
+        size_t const oldest = count > b->capacity ? count - b->capacity : 0;
+        summary.dropped_events += oldest;
+
+        int depth = 0;
+        for (size_t i = oldest; i < count; ++i) {
+            trace_event const& e = b->events[i % b->capacity];
+
+            if (e.phase == 'E' && depth == 0) {
+                ++summary.dropped_events;
+                continue;
+            }
+            depth += e.phase == 'B' ? 1 : -1;
+
+            std::snprintf(line, sizeof(line),
+                          "\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%lld.%03lld,\"pid\":1,\"tid\":%lu",
+                          e.category, e.phase, e.nanoseconds / 1000,
+                          e.nanoseconds % 1000, b->thread_id);
+            out << ",\n{\"name\":\"" << escape_json(e.name) << line;
+
+            if (!std::isnan(e.time)) {
+                std::snprintf(line, sizeof(line), ",\"args\":{\"time\":%.17g}", e.time);
+                out << line;
+            }
+
+            out << "}";
+            ++summary.events;
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    delete_buffers();
+
+    return summary;
+}
@@ -0,0 +1,180 @@
+#ifndef MODULE_TRACE_H
+#define MODULE_TRACE_H
+
+#include <string>
+#include <vector>
+#include <ostream>                     // for std::ostream
+#include <memory>                      // for unique_ptr
+#include <limits>                      // for std::numeric_limits
+#include "framework/state_map.h"       // for state_map, string_vector
+#include "framework/module_creator.h"  // for module_creator, mc_vector
+#include "framework/module.h"          // for module
+
+/**
+ *  @brief A summary of the events written by `stop_module_trace()`.
+ */
+struct module_trace_summary {
+    unsigned long events = 0;          // events written to the trace file
+    unsigned long dropped_events = 0;  // oldest events overwritten in a full buffer
+    unsigned long threads = 0;         // threads that recorded any events
+};
+
+/**
+ *  @brief Clears any previous trace and starts recording events, keeping at
+ *  most `events_per_thread` of the most recent events for each thread.
+ *
+ *  @details Starting, stopping, and writing a trace are not thread-safe, and
+ *  must not happen while a simulation is running. Recording events is
+ *  thread-safe and does not require any locks.
+ */
+void start_module_trace(size_t events_per_thread);
+
+/**
+ *  @brief Stops recording events, writes all recorded events to `out` in the
+ *  Chrome Trace Event JSON format, and then discards them.
+ */
+module_trace_summary stop_module_trace(std::ostream& out);
+
+bool module_trace_enabled();
+
+/**
+ *  @brief Returns a pointer to a copy of `name` that remains valid for the
+ *  rest of the session.
+ */
+char const* intern_trace_name(std::string const& name);
+
+/**
+ *  @brief Records the beginning (`phase = 'B'`) or end (`phase = 'E'`) of a
+ *  span of work on the calling thread, optionally including the simulation
+ *  time at which it occurs. Does nothing if a trace is not being recorded.
+ *
+ *  @details `name` and `category` must remain valid until the trace is
+ *  stopped; they are typically string literals or the results of
+ *  `intern_trace_name()`.
+ */
+void record_trace_event(
+    char const* name,
+    char const* category,
+    char phase,
+    double time = std::numeric_limits<double>::quiet_NaN());
+
+/**
+ *  @class traced_module
+ *
+ *  @brief Wraps a module, recording a trace event when each of its runs
+ *  begins and ends.
+ *
+ *  @details Every differential module runs exactly once each time an ODE
+ *  solver calculates the derivatives of a dynamical system, so a span named
+ *  `differential modules` that begins before the first differential module
+ *  and ends after the last one marks each derivative calculation (such as
+ *  each stage of a Runge-Kutta step), along with the simulation time at which
+ *  it was made.
+ */
+class traced_module : public module
+{
+   public:
+    traced_module(
+        std::unique_ptr<module> wrapped,
+        char const* name,
+        double const* time_ip,
+        bool begins_derivative,
+        bool ends_derivative)
+        : module(wrapped->is_differential(), wrapped->requires_euler_ode_solver()),
+          wrapped{std::move(wrapped)},
+          name{name},
+          time_ip{time_ip},
+          begins_derivative{begins_derivative},
+          ends_derivative{ends_derivative}
+    {
+    }
+
+   private:
+    std::unique_ptr<module> const wrapped;
+    char const* const name;
+    double const* time_ip;
+    bool const begins_derivative;
+    bool const ends_derivative;
+
+    void do_operation() const
+    {
+        if (begins_derivative) {
+            record_trace_event("differential modules", "solver", 'B', *time_ip);
+        }
+
+        record_trace_event(name, "module", 'B');
+        wrapped->run();
+        record_trace_event(name, "module", 'E');
+
+        if (ends_derivative) {
+            record_trace_event("differential modules", "solver", 'E');
+        }
+    }
+};
+
+/**
+ *  @class traced_module_creator
+ *
+ *  @brief A `module_creator` that wraps the modules created by another one in
+ *  `traced_module` objects. If the modules begin a derivative calculation,
+ *  the `time` quantity is added to the inputs of the wrapped module.
+ *
+ *  @details The wrapped creator is not owned by this object, and must outlive
+ *  it. Likewise, this object must outlive any modules it creates. Modules may
+ *  be created from several threads at once.
+ */
+class traced_module_creator : public module_creator
+{
+   public:
+    traced_module_creator(
+        module_creator* wrapped,
+        bool begins_derivative,
+        bool ends_derivative)
+        : wrapped{wrapped},
+          name{intern_trace_name(wrapped->get_name())},
+          begins_derivative{begins_derivative},
+          ends_derivative{ends_derivative}
+    {
+    }
+
+    string_vector get_inputs()
+    {
+        string_vector inputs = wrapped->get_inputs();
+        bool has_time = false;
+        for (std::string const& q : inputs) {
+            has_time = has_time || q == "time";
+        }
+        if (begins_derivative && !has_time) {
+            inputs.push_back("time");
+        }
+        return inputs;
+    }
+
+    string_vector get_outputs() { return wrapped->get_outputs(); }
+    std::string get_name() { return wrapped->get_name(); }
+
+    std::unique_ptr<module> create_module(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+    {
+        return std::unique_ptr<module>(new traced_module(
+            wrapped->create_module(input_quantities, output_quantities),
+            name,
+            begins_derivative ? get_ip(input_quantities, "time") : nullptr,
+            begins_derivative,
+            ends_derivative));
+    }
+
+   private:
+    module_creator* const wrapped;
+    char const* const name;
+    bool const begins_derivative;
+    bool const ends_derivative;
+};
+
+void trace_modules(
+    mc_vector& direct_mcs,
+    mc_vector& differential_mcs,
+    std::vector<std::unique_ptr<traced_module_creator>>& traced_mcs);
+
+#endif
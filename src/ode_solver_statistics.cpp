@@ -0,0 +1,167 @@
+#include <algorithm>  // for std::nth_element, std::min_element, std::max_element, std::upper_bound, std::max
+#include <cstdio>     // for std::snprintf
+#include <iterator>   // for std::distance
+#include <map>
+#include "ode_solver_statistics.h"
+
+using std::string;
+using std::vector;
+
+namespace
+{
+// The number of derivative evaluations made by each ODE solver for every
+// attempted step. The adaptive Cash-Karp solver calculates the derivative at
+// the start of each attempt and at five other points within it; since a
+// rejected attempt is retried from the same starting time, attempts can be
+// identified from the sequence of evaluation times. The Rosenbrock solver
+// also evaluates the derivatives to estimate the Jacobian matrix, so its
+// number of evaluations per step is not fixed.
+int evaluations_per_step(string const& solver_type)
+{
+    static std::map<string, int> const evaluations = {
+        {"homemade_euler", 1},
+        {"boost_euler", 1},
+        {"boost_rk4", 4},
+        {"boost_rkck54", 6}};
+
+    auto const it = evaluations.find(solver_type);
+    return it == evaluations.end() ? 0 : it->second;
+}
+
+// Returns the index of the output interval containing `time`, where interval
+// `k` begins at `output_times[k]`
+size_t output_interval(vector<double> const& output_times, double time)
+{
+    auto const it = std::upper_bound(output_times.begin(), output_times.end(), time);
+    size_t const index = it == output_times.begin()
+                             ? 0
+                             : static_cast<size_t>(std::distance(output_times.begin(), it)) - 1;
+    size_t const n_intervals = output_times.size() > 1 ? output_times.size() - 1 : 1;
+    return std::min(index, n_intervals - 1);
+}
+
+}  // namespace
+
+/**
+ *  @brief Summarizes the recorded derivative evaluations.
+ *
+ *  @details The wall time between each evaluation and the next one is
+ *           attributed to the output interval containing the simulation time
+ *           of the first evaluation, so the time per interval includes the
+ *           work done by the solver itself as well as the modules.
+ *
+ *           For solvers with a fixed number of evaluations per attempted
+ *           step, the evaluations are divided into attempts. An attempt is
+ *           rejected if the next attempt starts at the same time, and
+ *           otherwise it is accepted, with a step size equal to the
+ *           difference between the start times of the two attempts. The last
+ *           attempt is counted as accepted, but since its size is unknown it
+ *           is not included in the step size statistics.
+ *
+ *  @param [in] output_times The `time` column of the simulation result.
+ */
+ode_solver_statistics ode_solver_monitor::summarize(
+    string const& solver_type,
+    vector<double> const& output_times) const
+{
+    ode_solver_statistics stats;
+    stats.derivative_evaluations = times.size();
+
+    size_t const n_intervals = output_times.size() > 1 ? output_times.size() - 1 : 1;
+    stats.output_interval_seconds.assign(n_intervals, 0.0);
+
+    if (times.empty()) {
+        return stats;
+    }
+
+    for (size_t i = 0; i + 1 < times.size(); ++i) {
+        stats.output_interval_seconds[output_interval(output_times, times[i])] +=
+            wall_seconds[i + 1] - wall_seconds[i];
+    }
+
+    int const per_step = evaluations_per_step(solver_type);
+    if (per_step == 0 || times.size() % per_step != 0) {
+        return stats;
+    }
+
+    stats.steps_available = true;
+
+    vector<double> step_sizes;
+    vector<unsigned long> attempts_per_interval(n_intervals, 0);
+
+    for (size_t i = 0; i < times.size(); i += per_step) {
+        ++attempts_per_interval[output_interval(output_times, times[i])];
+
+        if (i + per_step >= times.size()) {
+            ++stats.accepted_steps;
+        } else if (times[i + per_step] == times[i]) {
+            ++stats.rejected_steps;
+        } else {
+            ++stats.accepted_steps;
+            step_sizes.push_back(times[i + per_step] - times[i]);
+        }
+    }
+
+    stats.max_attempts_per_output_interval =
+        *std::max_element(attempts_per_interval.begin(), attempts_per_interval.end());
+
+    if (!step_sizes.empty()) {
+        stats.min_step_size = *std::min_element(step_sizes.begin(), step_sizes.end());
+        stats.max_step_size = *std::max_element(step_sizes.begin(), step_sizes.end());
+
+        auto const middle = step_sizes.begin() + step_sizes.size() / 2;
+        std::nth_element(step_sizes.begin(), middle, step_sizes.end());
+        stats.median_step_size = *middle;
+    }
+
+    return stats;
+}
+
+/**
+ *  @brief Describes the statistics collected by an `ode_solver_monitor`.
+ */
+string ode_solver_statistics_report(ode_solver_statistics const& stats)
+{
+    vector<double> const& interval = stats.output_interval_seconds;
+    double const total_seconds = [&interval]() {
+        double total = 0.0;
+        for (double s : interval) {
+            total += s;
+        }
+        return total;
+    }();
+    double const max_interval_seconds =
+        interval.empty() ? 0.0 : *std::max_element(interval.begin(), interval.end());
+
+    char buffer[512];
+    std::snprintf(
+        buffer, sizeof(buffer),
+        "\nODE solver statistics:\n\n"
+        "  derivative evaluations: %lu\n"
+        "  time per output interval: %.3g ms (mean), %.3g ms (max)\n",
+        stats.derivative_evaluations,
+        interval.empty() ? 0.0 : 1e3 * total_seconds / interval.size(),
+        1e3 * max_interval_seconds);
+
+    string report = buffer;
+
+    if (stats.steps_available) {
+        std::snprintf(
+            buffer, sizeof(buffer),
+            "  accepted steps: %lu\n"
+            "  rejected steps: %lu\n"
+            "  most attempted steps in one output interval: %lu\n"
+            "  step size: %.3g (min), %.3g (median), %.3g (max)\n",
+            stats.accepted_steps,
+            stats.rejected_steps,
+            stats.max_attempts_per_output_interval,
+            stats.min_step_size,
+            stats.median_step_size,
+            stats.max_step_size);
+        report += buffer;
+    } else {
+        report += "  step statistics are not available for this ODE solver\n";
+    }
+
+    return report;
+}
@@ -0,0 +1,147 @@
+#ifndef ODE_SOLVER_STATISTICS_H
+#define ODE_SOLVER_STATISTICS_H
+
+#include <string>
+#include <vector>
+#include <chrono>                      // for std::chrono::steady_clock
+#include <memory>                      // for unique_ptr
+#include "framework/state_map.h"       // for state_map, string_vector
+#include "framework/module_creator.h"  // for module_creator
+#include "framework/module.h"          // for module
+
+/**
+ *  @brief A summary of the work done by an ODE solver during a simulation.
+ *
+ *  @details The step statistics are only available for solvers that evaluate
+ *  the derivatives a fixed number of times per attempted step; see
+ *  `ode_solver_monitor::summarize()`.
+ */
+struct ode_solver_statistics {
+    unsigned long derivative_evaluations = 0;
+    bool steps_available = false;
+    unsigned long accepted_steps = 0;
+    unsigned long rejected_steps = 0;
+    unsigned long max_attempts_per_output_interval = 0;
+    double min_step_size = 0.0;
+    double median_step_size = 0.0;
+    double max_step_size = 0.0;
+    std::vector<double> output_interval_seconds;  // wall time per interval
+};
+
+/**
+ *  @class ode_solver_monitor
+ *
+ *  @brief Records the time at which an ODE solver evaluates the derivatives of
+ *  a dynamical system, along with the wall time of each evaluation.
+ */
+class ode_solver_monitor
+{
+   public:
+    ode_solver_monitor() : start{std::chrono::steady_clock::now()} {}
+
+    void record(double time)
+    {
+        times.push_back(time);
+        wall_seconds.push_back(std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count());
+    }
+
+    ode_solver_statistics summarize(
+        std::string const& solver_type,
+        std::vector<double> const& output_times) const;
+
+   private:
+    std::chrono::steady_clock::time_point const start;
+    std::vector<double> times;         // simulation time of each evaluation
+    std::vector<double> wall_seconds;  // wall time of each evaluation
+};
+
+/**
+ *  @class monitored_module
+ *
+ *  @brief Wraps a differential module, notifying an `ode_solver_monitor`
+ *  each time it runs. Since every differential module runs exactly once
+ *  whenever the derivatives of a dynamical system are calculated, only one of
+ *  them needs to be wrapped.
+ */
+class monitored_module : public module
+{
+   public:
+    monitored_module(
+        std::unique_ptr<module> wrapped,
+        state_map const& input_quantities,
+        ode_solver_monitor& monitor)
+        : module(wrapped->is_differential(), wrapped->requires_euler_ode_solver()),
+          wrapped{std::move(wrapped)},
+          time_ip{get_ip(input_quantities, "time")},
+          monitor(monitor)
+    {
+    }
+
+   private:
+    std::unique_ptr<module> const wrapped;
+    double const* time_ip;
+    ode_solver_monitor& monitor;
+
+    void do_operation() const
+    {
+        monitor.record(*time_ip);
+        wrapped->run();
+    }
+};
+
+/**
+ *  @class monitored_module_creator
+ *
+ *  @brief A `module_creator` that wraps the modules created by another one in
+ *  `monitored_module` objects. The `time` quantity is added to the inputs of
+ *  the wrapped module.
+ *
+ *  @details The wrapped creator and the monitor are not owned by this object,
+ *  and must outlive it and any modules it creates.
+ */
+class monitored_module_creator : public module_creator
+{
+   public:
+    monitored_module_creator(
+        module_creator* wrapped,
+        ode_solver_monitor& monitor)
+        : wrapped{wrapped}, monitor(monitor)
+    {
+    }
+
+    string_vector get_inputs()
+    {
+        string_vector inputs = wrapped->get_inputs();
+        bool has_time = false;
+        for (std::string const& q : inputs) {
+            has_time = has_time || q == "time";
+        }
+        if (!has_time) {
+            inputs.push_back("time");
+        }
+        return inputs;
+    }
+
+    string_vector get_outputs() { return wrapped->get_outputs(); }
+    std::string get_name() { return wrapped->get_name(); }
+
+    std::unique_ptr<module> create_module(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+    {
+        return std::unique_ptr<module>(new monitored_module(
+            wrapped->create_module(input_quantities, output_quantities),
+            input_quantities,
+            monitor));
+    }
+
+   private:
+    module_creator* const wrapped;
+    ode_solver_monitor& monitor;
+};
+
+std::string ode_solver_statistics_report(ode_solver_statistics const& stats);
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef TIMED_MODULE_H
+#define TIMED_MODULE_H
+
+#include <string>
+#include <memory>                      // for unique_ptr
+#include <chrono>                      // for std::chrono::steady_clock
+#include <algorithm>                   // for std::max
+#include "framework/state_map.h"       // for state_map, string_vector
+#include "framework/module_creator.h"  // for module_creator
+#include "framework/module.h"          // for module
+#include "instruction_counter.h"
+
+/**
+ *  @brief Statistics about the runs of a `timed_module`.
+ */
+struct module_timing {
+    unsigned long calls = 0;
+    double total_seconds = 0.0;  // total wall time of all runs
+    double max_seconds = 0.0;    // wall time of the longest run
+    long long instructions = 0;  // instructions retired during all runs
+};
+
+/**
+ *  @class timed_module
+ *
+ *  @brief Wraps a module, recording the number of times it runs and the wall
+ *  time (and, if possible, the number of instructions) spent in it.
+ *
+ *  @details Each run requires two reads of a steady clock, which typically
+ *  take a few tens of nanoseconds in total. Reading the instruction counter
+ *  requires a system call, which is considerably slower, so it is only done
+ *  if the counter is available.
+ */
+class timed_module : public module
+{
+   public:
+    timed_module(
+        std::unique_ptr<module> wrapped,
+        module_timing& timing,
+        instruction_counter const& instructions)
+        : module(wrapped->is_differential(), wrapped->requires_euler_ode_solver()),
+          wrapped{std::move(wrapped)},
+          timing(timing),
+          instructions(instructions)
+    {
+    }
+
+   private:
+    std::unique_ptr<module> const wrapped;
+    module_timing& timing;
+    instruction_counter const& instructions;
+
+    void do_operation() const
+    {
+        using clock = std::chrono::steady_clock;
+
+        bool const count_instructions = instructions.available();
+        long long const start_instructions =
+            count_instructions ? instructions.read() : 0;
+        clock::time_point const start = clock::now();
+
+        wrapped->run();
+
+        double const seconds =
+            std::chrono::duration<double>(clock::now() - start).count();
+
+        if (count_instructions) {
+            timing.instructions += instructions.read() - start_instructions;
+        }
+
+        ++timing.calls;
+        timing.total_seconds += seconds;
+        timing.max_seconds = std::max(timing.max_seconds, seconds);
+    }
+};
+
+/**
+ *  @class timed_module_creator
+ *
+ *  @brief A `module_creator` that wraps the modules created by another one in
+ *  `timed_module` objects and collects their statistics.
+ *
+ *  @details The wrapped creator and the instruction counter are not owned by
+ *  this object, and must outlive it. Likewise, this object must outlive any
+ *  modules it creates.
+ */
+class timed_module_creator : public module_creator
+{
+   public:
+    timed_module_creator(
+        module_creator* wrapped,
+        instruction_counter const& instructions)
+        : wrapped{wrapped}, instructions(instructions)
+    {
+    }
+
+    string_vector get_inputs() { return wrapped->get_inputs(); }
+    string_vector get_outputs() { return wrapped->get_outputs(); }
+    std::string get_name() { return wrapped->get_name(); }
+
+    std::unique_ptr<module> create_module(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+    {
+        return std::unique_ptr<module>(new timed_module(
+            wrapped->create_module(input_quantities, output_quantities),
+            timing,
+            instructions));
+    }
+
+    module_timing const& get_timing() const { return timing; }
+
+   private:
+    module_creator* const wrapped;
+    instruction_counter const& instructions;
+    module_timing timing;
+};
+
+#endif